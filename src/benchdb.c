@@ -0,0 +1,777 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <omp.h>
+
+// 基准结果库：把 obj/matmuv_vN 的输出解析后追加到 JSON lines 文件，并按版本对比
+//
+//   benchdb record [-n 次数] [-o 文件] [--cflags 编译选项] -- 命令 [参数...]
+//   benchdb compare [-o 文件] [--base 版本] [--head 版本] [--threshold 百分比] [--confidence 置信度]
+//
+// 每一行输出里形如 "<数值> GFLOPS" 的都是一个指标。形状取最近一个含“形状”或“维度”的行 (小数替换成 #)；
+// 没有这样的标题行时 (如 v12 / v15 / v18 每行一个形状)，取该行开头到第一个双空格为止、含数字不含冒号的一列，
+// 如 "M=8192 N=1 K=8192"、"1000x600x300 f32 列"。
+// 指标名只由形状下的行号、数值前的标签 (如“调度:”) 和行内序号组成，不随程序选出的方案变化；
+// 整行去掉小数后的文本 (含调度器、规划器打印的方案) 作为 plan 单独保存，对比时方案变化会标出来
+#define DEFAULT_STORE "results/bench.jsonl"
+#define DEFAULT_SAMPLES 5
+#define MAX_SAMPLES 64
+#define MAX_LINE 4096
+#define TEXT_LEN 512
+
+// 一个指标在一次 record 中的全部样本
+typedef struct {
+    char shape[TEXT_LEN];
+    char metric[TEXT_LEN];
+    char plan[TEXT_LEN];
+    int count;
+    double samples[MAX_SAMPLES];
+} series;
+
+// 结果库里的一条记录
+typedef struct {
+    char machine[32];
+    char rev[64];
+    char kernel[128];
+    char shape[TEXT_LEN];
+    char metric[TEXT_LEN];
+    char plan[TEXT_LEN];
+    char cflags[TEXT_LEN];
+    int threads;
+    int count;
+    double samples[MAX_SAMPLES];
+} record;
+
+typedef struct {
+    char fingerprint[32];
+    char cpu[256];
+    long ncpu;
+    long mem_kb;
+} machine_info;
+
+static void* xrealloc(void* p, size_t size) {
+    p = realloc(p, size);
+    if (!p) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static void copy_text(char* dst, const char* src, size_t size) {
+    snprintf(dst, size, "%s", src);
+}
+
+// ---------------- 机器指纹与版本 ----------------
+
+static uint64_t fnv1a(const char* s) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (; *s; s++) {
+        h ^= (unsigned char)*s;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+// 指纹 = hash(CPU 型号 | 逻辑核数 | 内存总量)
+void machine_detect(machine_info* mi) {
+    char line[MAX_LINE];
+    copy_text(mi->cpu, "unknown", sizeof(mi->cpu));
+    mi->mem_kb = 0;
+    mi->ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    FILE* f = fopen("/proc/cpuinfo", "r");
+    if (f) {
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, "model name", 10) == 0) {
+                char* v = strchr(line, ':');
+                if (v) {
+                    v++;
+                    while (*v == ' ') v++;
+                    v[strcspn(v, "\n")] = '\0';
+                    copy_text(mi->cpu, v, sizeof(mi->cpu));
+                }
+                break;
+            }
+        }
+        fclose(f);
+    }
+    f = fopen("/proc/meminfo", "r");
+    if (f) {
+        while (fgets(line, sizeof(line), f)) {
+            if (sscanf(line, "MemTotal: %ld kB", &mi->mem_kb) == 1) break;
+        }
+        fclose(f);
+    }
+
+    char key[MAX_LINE];
+    snprintf(key, sizeof(key), "%s|%ld|%ld", mi->cpu, mi->ncpu, mi->mem_kb);
+    snprintf(mi->fingerprint, sizeof(mi->fingerprint), "%016llx", (unsigned long long)fnv1a(key));
+}
+
+// 运行命令并取第一行输出，失败时返回 0
+static int command_line(const char* cmd, char* out, size_t size) {
+    FILE* p = popen(cmd, "r");
+    if (!p) return 0;
+    int ok = fgets(out, (int)size, p) != NULL;
+    pclose(p);
+    if (ok) out[strcspn(out, "\n")] = '\0';
+    return ok;
+}
+
+// 当前 git 版本；工作区有未提交的改动时加 -dirty 后缀，不在仓库里时为 unknown
+void git_revision(char* rev, size_t size) {
+    char line[256];
+    if (!command_line("git rev-parse --short=12 HEAD 2>/dev/null", line, sizeof(line))) {
+        copy_text(rev, "unknown", size);
+        return;
+    }
+    char status[256];
+    int dirty = command_line("git status --porcelain --untracked-files=no 2>/dev/null", status, sizeof(status));
+    snprintf(rev, size, "%s%s", line, dirty ? "-dirty" : "");
+}
+
+// ---------------- 输出解析 ----------------
+
+static int is_float_at(const char* s, int* len) {
+    const char* p = s;
+    if (*p == '-' || *p == '+') p++;
+    if (!isdigit((unsigned char)*p)) return 0;
+    while (isdigit((unsigned char)*p)) p++;
+    int is_float = 0;
+    if (*p == '.' && isdigit((unsigned char)p[1])) {
+        is_float = 1;
+        p++;
+        while (isdigit((unsigned char)*p)) p++;
+    }
+    if ((*p == 'e' || *p == 'E') && (isdigit((unsigned char)p[1]) ||
+        ((p[1] == '-' || p[1] == '+') && isdigit((unsigned char)p[2])))) {
+        is_float = 1;
+        p += 2;
+        while (isdigit((unsigned char)*p)) p++;
+    }
+    *len = (int)(p - s);
+    return is_float;
+}
+
+// 小数替换成 #，连续空白压成一个空格，去掉首尾空白
+void line_template(const char* line, char* out, size_t size) {
+    size_t n = 0;
+    int space = 0;
+    for (const char* p = line; *p && n + 2 < size;) {
+        int len;
+        int prev_alnum = p > line && (isalnum((unsigned char)p[-1]) || p[-1] == '.');
+        if (!prev_alnum && is_float_at(p, &len)) {
+            if (space && n > 0) out[n++] = ' ';
+            space = 0;
+            out[n++] = '#';
+            p += len;
+        } else if (isspace((unsigned char)*p)) {
+            space = 1;
+            p++;
+        } else {
+            if (space && n > 0) out[n++] = ' ';
+            space = 0;
+            out[n++] = *p++;
+        }
+    }
+    out[n] = '\0';
+}
+
+static series* series_find(series** list, int* count, const char* shape, const char* metric) {
+    for (int i = 0; i < *count; i++) {
+        if (strcmp((*list)[i].shape, shape) == 0 && strcmp((*list)[i].metric, metric) == 0) return &(*list)[i];
+    }
+    *list = (series*)xrealloc(*list, sizeof(series) * (*count + 1));
+    series* s = &(*list)[(*count)++];
+    copy_text(s->shape, shape, sizeof(s->shape));
+    copy_text(s->metric, metric, sizeof(s->metric));
+    s->plan[0] = '\0';
+    s->count = 0;
+    return s;
+}
+
+// 数值前紧挨着的以冒号结尾的标签，如“性能:”；没有时为空串
+static void value_label(const char* line, const char* value, char* out, size_t size) {
+    const char* end = value;
+    while (end > line && end[-1] == ' ') end--;
+    const char* begin = end;
+    while (begin > line && begin[-1] != ' ') begin--;
+    size_t len = (size_t)(end - begin);
+    if (len == 0 || begin[len - 1] != ':' || len >= size) len = 0;
+    memcpy(out, begin, len);
+    out[len] = '\0';
+}
+
+// 行首的形状列：到第一个双空格为止，必须含数字且不含冒号；没有时返回 0
+static int line_shape(const char* line, char* out, size_t size) {
+    while (*line == ' ') line++;
+    const char* end = strstr(line, "  ");
+    size_t len = end ? (size_t)(end - line) : strlen(line);
+    char col[TEXT_LEN];
+    if (len == 0 || len >= sizeof(col)) return 0;
+    memcpy(col, line, len);
+    col[len] = '\0';
+    if (strchr(col, ':') || !strpbrk(col, "0123456789")) return 0;
+    line_template(col, out, size);
+    return 1;
+}
+
+// 解析一次运行的输出，把每个 GFLOPS 数值追加到对应指标的样本里；返回找到的数值个数
+int parse_output(FILE* in, series** list, int* count) {
+    char line[MAX_LINE], shape[TEXT_LEN] = "", metric[TEXT_LEN], tmpl[TEXT_LEN], label[64];
+    char own[TEXT_LEN];
+    // 本次运行里出现过的行首形状，同一形状出现多行时按出现次序编行号
+    char (*seen)[TEXT_LEN] = NULL;
+    int found = 0, row = 0, nseen = 0;
+    while (fgets(line, sizeof(line), in)) {
+        fputs(line, stdout);
+        line[strcspn(line, "\n")] = '\0';
+        if (!strstr(line, "GFLOPS")) {
+            if (strstr(line, "形状") || strstr(line, "维度")) {
+                line_template(line, shape, sizeof(shape));
+                row = 0;
+            }
+            continue;
+        }
+
+        row++;
+        const char* key_shape = shape;
+        int key_row = row;
+        if (!shape[0] && line_shape(line, own, sizeof(own))) {
+            key_shape = own;
+            key_row = 1;
+            for (int i = 0; i < nseen; i++) key_row += strcmp(seen[i], own) == 0;
+            seen = (char(*)[TEXT_LEN])xrealloc(seen, sizeof(*seen) * (nseen + 1));
+            copy_text(seen[nseen++], own, sizeof(seen[0]));
+        }
+        line_template(line, tmpl, sizeof(tmpl));
+        int occurrences = 0;
+        for (const char* p = line; (p = strstr(p, "GFLOPS")); p++) occurrences++;
+
+        int index = 0;
+        for (const char* p = line; (p = strstr(p, "GFLOPS")); p++) {
+            index++;
+            // 数值紧挨在 GFLOPS 前面 (可以隔着空白)
+            const char* end = p;
+            while (end > line && end[-1] == ' ') end--;
+            const char* begin = end;
+            while (begin > line && (isdigit((unsigned char)begin[-1]) || begin[-1] == '.' ||
+                                    begin[-1] == 'e' || begin[-1] == '-' || begin[-1] == '+')) begin--;
+            if (begin == end) continue;
+            double v = strtod(begin, NULL);
+            value_label(line, begin, label, sizeof(label));
+            int n = snprintf(metric, sizeof(metric), "第 %d 行%s%s", key_row, label[0] ? " " : "", label);
+            if (occurrences > 1) snprintf(metric + n, sizeof(metric) - n, " [%d]", index);
+
+            series* s = series_find(list, count, key_shape, metric);
+            if (s->count == 0) {
+                copy_text(s->plan, tmpl, sizeof(s->plan));
+            } else if (strcmp(s->plan, tmpl) != 0 && !strstr(s->plan, " (样本间方案不同)")) {
+                // 同一次 record 内方案也变了：保留第一次的文本并注明
+                size_t len = strlen(s->plan);
+                if (len + 32 > sizeof(s->plan)) len = sizeof(s->plan) - 32;
+                snprintf(s->plan + len, sizeof(s->plan) - len, " (样本间方案不同)");
+            }
+            if (s->count < MAX_SAMPLES) s->samples[s->count++] = v;
+            found++;
+        }
+    }
+    free(seen);
+    return found;
+}
+
+// ---------------- JSON lines 读写 ----------------
+
+static void json_string(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', f);
+            fputc(c, f);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+// 记录都是本工具写的，键名后面紧跟冒号；字符串值里的引号都被转义过，不会误配
+static const char* json_find(const char* line, const char* key) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char* p = strstr(line, pattern);
+    return p ? p + strlen(pattern) : NULL;
+}
+
+static int json_get_string(const char* line, const char* key, char* out, size_t size) {
+    const char* p = json_find(line, key);
+    if (!p || *p != '"') return 0;
+    p++;
+    size_t n = 0;
+    while (*p && *p != '"') {
+        char c = *p++;
+        if (c == '\\' && *p) {
+            c = *p++;
+            if (c == 'u') {
+                unsigned v = 0;
+                sscanf(p, "%4x", &v);
+                p += 4;
+                c = (char)v;
+            }
+        }
+        if (n + 1 < size) out[n++] = c;
+    }
+    out[n] = '\0';
+    return 1;
+}
+
+static int json_get_samples(const char* line, double* out, int cap) {
+    const char* p = json_find(line, "samples");
+    if (!p || *p != '[') return 0;
+    p++;
+    int n = 0;
+    while (*p && *p != ']' && n < cap) {
+        char* end;
+        double v = strtod(p, &end);
+        if (end == p) break;
+        out[n++] = v;
+        p = end;
+        while (*p == ',' || *p == ' ') p++;
+    }
+    return n;
+}
+
+static void ensure_parent_dir(const char* path) {
+    char dir[TEXT_LEN];
+    copy_text(dir, path, sizeof(dir));
+    char* slash = strrchr(dir, '/');
+    if (!slash) return;
+    *slash = '\0';
+    for (char* p = dir + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(dir, 0755);
+            *p = '/';
+        }
+    }
+    mkdir(dir, 0755);
+}
+
+int append_records(const char* store, const machine_info* mi, const char* rev, const char* kernel,
+                   const char* cflags, int threads, const series* list, int count) {
+    ensure_parent_dir(store);
+    FILE* f = fopen(store, "a");
+    if (!f) {
+        fprintf(stderr, "无法写入结果库 %s\n", store);
+        return -1;
+    }
+    char stamp[32];
+    time_t now = time(NULL);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    for (int i = 0; i < count; i++) {
+        const series* s = &list[i];
+        fprintf(f, "{\"time\":\"%s\",\"machine\":\"%s\",\"cpu\":", stamp, mi->fingerprint);
+        json_string(f, mi->cpu);
+        fprintf(f, ",\"ncpu\":%ld,\"mem_kb\":%ld,\"rev\":", mi->ncpu, mi->mem_kb);
+        json_string(f, rev);
+        fprintf(f, ",\"kernel\":");
+        json_string(f, kernel);
+        fprintf(f, ",\"shape\":");
+        json_string(f, s->shape);
+        fprintf(f, ",\"metric\":");
+        json_string(f, s->metric);
+        fprintf(f, ",\"plan\":");
+        json_string(f, s->plan);
+        fprintf(f, ",\"threads\":%d,\"cflags\":", threads);
+        json_string(f, cflags);
+        fprintf(f, ",\"unit\":\"GFLOPS\",\"samples\":[");
+        for (int j = 0; j < s->count; j++) fprintf(f, "%s%.4f", j ? "," : "", s->samples[j]);
+        fprintf(f, "]}\n");
+    }
+    fclose(f);
+    return 0;
+}
+
+// 读入结果库的全部记录，按写入顺序 (也就是时间顺序) 排列
+record* load_records(const char* store, int* count) {
+    *count = 0;
+    FILE* f = fopen(store, "r");
+    if (!f) return NULL;
+
+    record* list = NULL;
+    char* line = NULL;
+    size_t cap = 0;
+    while (getline(&line, &cap, f) > 0) {
+        record r;
+        memset(&r, 0, sizeof(r));
+        if (!json_get_string(line, "machine", r.machine, sizeof(r.machine)) ||
+            !json_get_string(line, "rev", r.rev, sizeof(r.rev)) ||
+            !json_get_string(line, "kernel", r.kernel, sizeof(r.kernel))) continue;
+        json_get_string(line, "shape", r.shape, sizeof(r.shape));
+        json_get_string(line, "metric", r.metric, sizeof(r.metric));
+        json_get_string(line, "plan", r.plan, sizeof(r.plan));
+        json_get_string(line, "cflags", r.cflags, sizeof(r.cflags));
+        const char* t = json_find(line, "threads");
+        r.threads = t ? atoi(t) : 0;
+        r.count = json_get_samples(line, r.samples, MAX_SAMPLES);
+        list = (record*)xrealloc(list, sizeof(record) * (*count + 1));
+        list[(*count)++] = r;
+    }
+    free(line);
+    fclose(f);
+    return list;
+}
+
+// ---------------- 统计 ----------------
+
+// 不完全 Beta 函数的连分式 (Lentz 方法)
+static double beta_cf(double a, double b, double x) {
+    const double tiny = 1e-300;
+    double qab = a + b, qap = a + 1.0, qam = a - 1.0;
+    double c = 1.0, d = 1.0 - qab * x / qap;
+    if (fabs(d) < tiny) d = tiny;
+    d = 1.0 / d;
+    double h = d;
+    for (int m = 1; m <= 300; m++) {
+        int m2 = 2 * m;
+        double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+        d = 1.0 + aa * d;
+        if (fabs(d) < tiny) d = tiny;
+        c = 1.0 + aa / c;
+        if (fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        h *= d * c;
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+        d = 1.0 + aa * d;
+        if (fabs(d) < tiny) d = tiny;
+        c = 1.0 + aa / c;
+        if (fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        double del = d * c;
+        h *= del;
+        if (fabs(del - 1.0) < 1e-12) break;
+    }
+    return h;
+}
+
+// 正则化不完全 Beta 函数 I_x(a, b)
+static double inc_beta(double a, double b, double x) {
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    double bt = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1.0 - x));
+    if (x < (a + 1.0) / (a + b + 2.0)) return bt * beta_cf(a, b, x) / a;
+    return 1.0 - bt * beta_cf(b, a, 1.0 - x) / b;
+}
+
+// 自由度 df 的 t 分布双侧分位数：P(|T| <= t) = conf，二分求解
+double t_quantile(double conf, double df) {
+    double lo = 0.0, hi = 1000.0;
+    for (int i = 0; i < 200; i++) {
+        double mid = 0.5 * (lo + hi);
+        double p = 1.0 - inc_beta(0.5 * df, 0.5, df / (df + mid * mid));
+        if (p < conf) lo = mid; else hi = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
+typedef struct {
+    int n;
+    double mean, var;
+} sample_stats;
+
+static void stats_add(sample_stats* st, const double* v, int n, double* sum, double* sum2) {
+    for (int i = 0; i < n; i++) {
+        *sum += v[i];
+        *sum2 += v[i] * v[i];
+    }
+    st->n += n;
+}
+
+static void stats_finish(sample_stats* st, double sum, double sum2) {
+    st->mean = st->n ? sum / st->n : 0.0;
+    st->var = st->n > 1 ? fmax(0.0, (sum2 - sum * sum / st->n) / (st->n - 1)) : 0.0;
+}
+
+typedef enum { VERDICT_SAME, VERDICT_SLOWER, VERDICT_REGRESSION, VERDICT_FASTER, VERDICT_TOO_FEW } verdict;
+
+// Welch t 区间：均值差 (当前 - 基准) 的置信区间，再除以基准均值得到相对变化
+// 基准均值本身的不确定度忽略不计，样本数较多时影响很小
+verdict welch_compare(const sample_stats* base, const sample_stats* head, double conf, double threshold,
+                      double* rel, double* rel_lo, double* rel_hi) {
+    if (base->n < 2 || head->n < 2 || base->mean <= 0.0) return VERDICT_TOO_FEW;
+    double vb = base->var / base->n, vh = head->var / head->n;
+    double se = sqrt(vb + vh);
+    double diff = head->mean - base->mean;
+    double half = 0.0;
+    if (se > 0.0) {
+        double denom = 0.0;
+        if (vb > 0.0) denom += vb * vb / (base->n - 1);
+        if (vh > 0.0) denom += vh * vh / (head->n - 1);
+        double df = denom > 0.0 ? (vb + vh) * (vb + vh) / denom : base->n + head->n - 2;
+        half = t_quantile(conf, df) * se;
+    }
+    *rel = diff / base->mean;
+    *rel_lo = (diff - half) / base->mean;
+    *rel_hi = (diff + half) / base->mean;
+
+    if (*rel_hi < 0.0) return -*rel * 100.0 >= threshold ? VERDICT_REGRESSION : VERDICT_SLOWER;
+    if (*rel_lo > 0.0) return VERDICT_FASTER;
+    return VERDICT_SAME;
+}
+
+// ---------------- 子命令 ----------------
+
+static void usage(void) {
+    fprintf(stderr,
+            "用法:\n"
+            "  benchdb record [-n 次数] [-o 文件] [--cflags 编译选项] -- 命令 [参数...]\n"
+            "  benchdb compare [-o 文件] [--base 版本] [--head 版本] [--threshold 百分比] [--confidence 置信度]\n");
+}
+
+// 追加字符串，放不下时返回 -1 且不写入
+static int text_append(char* buf, size_t size, size_t* n, const char* s, size_t len) {
+    if (len >= size - *n) return -1;
+    memcpy(buf + *n, s, len);
+    *n += len;
+    buf[*n] = '\0';
+    return 0;
+}
+
+// 命令的每个参数都用单引号包起来再交给 shell；放不下时返回 -1，不截断
+int build_command(char** args, int count, char* cmd, size_t size) {
+    size_t n = 0;
+    cmd[0] = '\0';
+    for (int a = 0; a < count; a++) {
+        if (a > 0 && text_append(cmd, size, &n, " ", 1)) return -1;
+        if (text_append(cmd, size, &n, "'", 1)) return -1;
+        for (const char* p = args[a]; *p; p++) {
+            int rc = *p == '\'' ? text_append(cmd, size, &n, "'\\''", 4) : text_append(cmd, size, &n, p, 1);
+            if (rc) return -1;
+        }
+        if (text_append(cmd, size, &n, "'", 1)) return -1;
+    }
+    return 0;
+}
+
+int cmd_record(int argc, char** argv) {
+    const char* store = DEFAULT_STORE;
+    const char* cflags = "";
+    int samples = DEFAULT_SAMPLES;
+    int i = 0;
+    for (; i < argc; i++) {
+        if (strcmp(argv[i], "--") == 0) {
+            i++;
+            break;
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            store = argv[++i];
+        } else if (strcmp(argv[i], "--cflags") == 0 && i + 1 < argc) {
+            cflags = argv[++i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (i >= argc || samples < 2 || samples > MAX_SAMPLES) {
+        if (samples < 2 || samples > MAX_SAMPLES) fprintf(stderr, "样本数必须在 2 到 %d 之间\n", MAX_SAMPLES);
+        usage();
+        return 2;
+    }
+
+    char cmd[MAX_LINE];
+    if (build_command(argv + i, argc - i, cmd, sizeof(cmd))) {
+        fprintf(stderr, "命令过长：加引号后超过 %zu 字节\n", sizeof(cmd) - 1);
+        return 2;
+    }
+
+    const char* kernel = strrchr(argv[i], '/');
+    kernel = kernel ? kernel + 1 : argv[i];
+    const char* env_threads = getenv("OMP_NUM_THREADS");
+    int threads = env_threads ? atoi(env_threads) : omp_get_max_threads();
+
+    machine_info mi;
+    char rev[64];
+    machine_detect(&mi);
+    git_revision(rev, sizeof(rev));
+
+    series* list = NULL;
+    int count = 0;
+    for (int s = 0; s < samples; s++) {
+        printf("== %s 第 %d/%d 次 ==\n", kernel, s + 1, samples);
+        fflush(stdout);
+        FILE* p = popen(cmd, "r");
+        if (!p) {
+            fprintf(stderr, "无法运行: %s\n", cmd);
+            return 1;
+        }
+        int found = parse_output(p, &list, &count);
+        int status = pclose(p);
+        if (status != 0) {
+            fprintf(stderr, "命令以非零状态退出: %s\n", cmd);
+            free(list);
+            return 1;
+        }
+        if (found == 0) {
+            fprintf(stderr, "输出中没有找到 GFLOPS 数值: %s\n", cmd);
+            free(list);
+            return 1;
+        }
+    }
+
+    int rc = append_records(store, &mi, rev, kernel, cflags, threads, list, count);
+    if (rc == 0) printf("已记录 %d 项指标到 %s (机器 %s, 版本 %s, 线程 %d)\n", count, store, mi.fingerprint, rev, threads);
+    free(list);
+    return rc ? 1 : 0;
+}
+
+static int same_key(const record* a, const record* b) {
+    return a->threads == b->threads && strcmp(a->kernel, b->kernel) == 0 && strcmp(a->shape, b->shape) == 0 &&
+           strcmp(a->metric, b->metric) == 0 && strcmp(a->cflags, b->cflags) == 0;
+}
+
+// 汇总某版本下与 key 相同的全部样本 (多次 record 的样本合并)，plan 取该版本最后一次记录的方案
+static sample_stats pool(const record* list, int count, const char* machine, const char* rev, const record* key,
+                         const char** plan) {
+    sample_stats st = {0, 0.0, 0.0};
+    double sum = 0.0, sum2 = 0.0;
+    *plan = "";
+    for (int i = 0; i < count; i++) {
+        const record* r = &list[i];
+        if (strcmp(r->machine, machine) == 0 && strcmp(r->rev, rev) == 0 && same_key(r, key)) {
+            stats_add(&st, r->samples, r->count, &sum, &sum2);
+            *plan = r->plan;
+        }
+    }
+    stats_finish(&st, sum, sum2);
+    return st;
+}
+
+int cmd_compare(int argc, char** argv) {
+    const char* store = DEFAULT_STORE;
+    const char* base_rev = NULL;
+    const char* head_rev = NULL;
+    double threshold = 3.0, conf = 0.95;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            store = argv[++i];
+        } else if (strcmp(argv[i], "--base") == 0 && i + 1 < argc) {
+            base_rev = argv[++i];
+        } else if (strcmp(argv[i], "--head") == 0 && i + 1 < argc) {
+            head_rev = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--confidence") == 0 && i + 1 < argc) {
+            conf = atof(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (conf <= 0.0 || conf >= 1.0) {
+        fprintf(stderr, "置信度必须在 0 和 1 之间\n");
+        return 2;
+    }
+
+    machine_info mi;
+    machine_detect(&mi);
+    int count;
+    record* list = load_records(store, &count);
+
+    // 只比较本机的记录；默认当前版本是最后写入的版本，基准是在它之前最近的另一个版本
+    int head_idx = -1, base_idx = -1;
+    for (int i = count - 1; i >= 0; i--) {
+        if (strcmp(list[i].machine, mi.fingerprint) != 0) continue;
+        if (head_idx < 0 && (!head_rev || strcmp(list[i].rev, head_rev) == 0)) head_idx = i;
+    }
+    if (head_idx >= 0) head_rev = list[head_idx].rev;
+    // 默认基准只在 head 最后一条记录之前找，指定较旧的 --head 时也不会拿更新的版本当基准；显式 --base 按指定的来
+    for (int i = base_rev ? count - 1 : head_idx - 1; i >= 0 && head_idx >= 0; i--) {
+        if (strcmp(list[i].machine, mi.fingerprint) != 0 || strcmp(list[i].rev, head_rev) == 0) continue;
+        if (!base_rev || strcmp(list[i].rev, base_rev) == 0) {
+            base_idx = i;
+            break;
+        }
+    }
+    if (head_idx < 0 || base_idx < 0) {
+        fprintf(stderr, "结果库 %s 中本机 (%s) 没有可供对比的两个版本\n", store, mi.fingerprint);
+        free(list);
+        return 2;
+    }
+    base_rev = list[base_idx].rev;
+
+    printf("机器: %s (%s, %ld 核)\n", mi.fingerprint, mi.cpu, mi.ncpu);
+    printf("基准版本: %s  当前版本: %s  置信度: %.0f%%  回退阈值: %.1f%%\n", base_rev, head_rev, conf * 100.0, threshold);
+
+    int totals[VERDICT_TOO_FEW + 1] = {0};
+    static const char* verdict_names[] = { "无显著差异", "显著变慢 (低于阈值)", "回退", "提升", "样本不足" };
+    const char* last_kernel = "";
+    for (int i = 0; i < count; i++) {
+        const record* key = &list[i];
+        if (strcmp(key->machine, mi.fingerprint) != 0 || strcmp(key->rev, head_rev) != 0) continue;
+        // 同一个 key 只处理第一次出现
+        int seen = 0;
+        for (int j = 0; j < i && !seen; j++) {
+            seen = strcmp(list[j].machine, mi.fingerprint) == 0 && strcmp(list[j].rev, head_rev) == 0 &&
+                   same_key(&list[j], key);
+        }
+        if (seen) continue;
+
+        const char *base_plan, *head_plan;
+        sample_stats base = pool(list, count, mi.fingerprint, base_rev, key, &base_plan);
+        if (base.n == 0) continue;
+        sample_stats head = pool(list, count, mi.fingerprint, head_rev, key, &head_plan);
+
+        double rel = 0.0, lo = 0.0, hi = 0.0;
+        verdict v = welch_compare(&base, &head, conf, threshold, &rel, &lo, &hi);
+        totals[v]++;
+
+        if (strcmp(last_kernel, key->kernel) != 0) {
+            printf("[%s] 线程 %d  %s\n", key->kernel, key->threads, key->cflags);
+            last_kernel = key->kernel;
+        }
+        printf("  %s%s%s\n", key->shape, key->shape[0] ? " | " : "", key->metric);
+        if (strcmp(base_plan, head_plan) != 0) {
+            printf("    方案已变化: %s\n              -> %s\n", base_plan, head_plan);
+        } else if (head_plan[0]) {
+            printf("    %s\n", head_plan);
+        }
+        printf("    基准 %.2f ± %.2f (n=%d)  当前 %.2f ± %.2f (n=%d)", base.mean, sqrt(base.var), base.n,
+               head.mean, sqrt(head.var), head.n);
+        if (v == VERDICT_TOO_FEW) {
+            printf("  %s\n", verdict_names[v]);
+        } else {
+            printf("  变化 %+.1f%% [%+.1f%%, %+.1f%%]  %s\n", rel * 100.0, lo * 100.0, hi * 100.0, verdict_names[v]);
+        }
+    }
+
+    printf("共比较 %d 项: 回退 %d，显著变慢但低于阈值 %d，提升 %d，无显著差异 %d，样本不足 %d\n",
+           totals[VERDICT_SAME] + totals[VERDICT_SLOWER] + totals[VERDICT_REGRESSION] + totals[VERDICT_FASTER] +
+               totals[VERDICT_TOO_FEW],
+           totals[VERDICT_REGRESSION], totals[VERDICT_SLOWER], totals[VERDICT_FASTER], totals[VERDICT_SAME],
+           totals[VERDICT_TOO_FEW]);
+    free(list);
+    return totals[VERDICT_REGRESSION] ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    if (strcmp(argv[1], "record") == 0) return cmd_record(argc - 2, argv + 2);
+    if (strcmp(argv[1], "compare") == 0) return cmd_compare(argc - 2, argv + 2);
+    usage();
+    return 2;
+}
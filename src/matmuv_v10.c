@@ -0,0 +1,371 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include <immintrin.h>
+
+// 微内核寄存器分块：MR 行 x NR 列 (2 个 zmm)
+#define MR 8
+#define NR 32
+// 缓存分块：A 块 MC x KC 常驻 L2，B 微面板 KC x NR 常驻 L1
+#define MC_BLOCK 128
+#define KC_BLOCK 256
+#define NC_BLOCK 2048
+// K 不超过该值时走外积路径，打包开销已经大于计算
+#define TINY_K 16
+// split-K 部分和缓冲区的上限 (字节)
+#define SPLIT_K_MAX_BYTES (1ul << 30)
+
+// 代价模型常数：单线程 FLOP/ns 与单线程搬运带宽 B/ns
+#define COST_FLOP_RATE 100.0
+#define COST_MOVE_RATE 10.0
+
+typedef enum { PLAN_ROWS, PLAN_COLS, PLAN_GRID, PLAN_SPLIT_K, PLAN_OUTER } plan_kind;
+
+// 线程网格：tm x tn x tk，tk > 1 时为 split-K
+typedef struct {
+    plan_kind kind;
+    int tm, tn, tk;
+} gemm_plan;
+
+static const char* plan_name(plan_kind kind) {
+    switch (kind) {
+        case PLAN_ROWS:    return "按行划分";
+        case PLAN_COLS:    return "按列划分";
+        case PLAN_GRID:    return "二维划分";
+        case PLAN_SPLIT_K: return "split-K";
+        case PLAN_OUTER:   return "外积";
+    }
+    return "?";
+}
+
+static inline int min_int(int a, int b) { return a < b ? a : b; }
+static inline int ceil_div(int a, int b) { return (a + b - 1) / b; }
+
+// 尾部掩码：n 个有效元素 (n 可以 <= 0 或 >= 16)
+static inline __mmask16 tail_mask(int n) {
+    if (n >= 16) return 0xFFFF;
+    if (n <= 0) return 0;
+    return (__mmask16)((1u << n) - 1);
+}
+
+// 打包 A 的 mc x kc 块：每 MR 行一个微面板，按 k 连续存放，不足 MR 行补零
+void pack_a(int mc, int kc, const float* A, int lda, float* pa) {
+    for (int i = 0; i < mc; i += MR) {
+        int mr = min_int(MR, mc - i);
+        for (int k = 0; k < kc; k++) {
+            for (int r = 0; r < mr; r++) pa[r] = A[(size_t)(i + r) * lda + k];
+            for (int r = mr; r < MR; r++) pa[r] = 0.0f;
+            pa += MR;
+        }
+    }
+}
+
+// 打包 B 的 kc x nc 块：每 NR 列一个微面板，不足 NR 列补零
+void pack_b(int kc, int nc, const float* B, int ldb, float* pb) {
+    for (int j = 0; j < nc; j += NR) {
+        __mmask16 m0 = tail_mask(nc - j);
+        __mmask16 m1 = tail_mask(nc - j - 16);
+        for (int k = 0; k < kc; k++) {
+            const float* b = B + (size_t)k * ldb + j;
+            _mm512_store_ps(pb, _mm512_maskz_loadu_ps(m0, b));
+            _mm512_store_ps(pb + 16, _mm512_maskz_loadu_ps(m1, b + 16));
+            pb += NR;
+        }
+    }
+}
+
+// 微内核：C[mr x nr] += pa * pb，累加器全部放在寄存器里
+void micro_kernel(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr) {
+    __m512 c0[MR], c1[MR];
+    for (int r = 0; r < MR; r++) {
+        c0[r] = _mm512_setzero_ps();
+        c1[r] = _mm512_setzero_ps();
+    }
+
+    for (int k = 0; k < kc; k++) {
+        __m512 b0 = _mm512_load_ps(pb);
+        __m512 b1 = _mm512_load_ps(pb + 16);
+        for (int r = 0; r < MR; r++) {
+            __m512 a = _mm512_set1_ps(pa[r]);
+            c0[r] = _mm512_fmadd_ps(a, b0, c0[r]);
+            c1[r] = _mm512_fmadd_ps(a, b1, c1[r]);
+        }
+        pa += MR;
+        pb += NR;
+    }
+
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int r = 0; r < mr; r++) {
+        float* c = C + (size_t)r * ldc;
+        _mm512_mask_storeu_ps(c, m0, _mm512_add_ps(c0[r], _mm512_maskz_loadu_ps(m0, c)));
+        _mm512_mask_storeu_ps(c + 16, m1, _mm512_add_ps(c1[r], _mm512_maskz_loadu_ps(m1, c + 16)));
+    }
+}
+
+// 单线程分块 GEMM：C[m x n] += A[m x k] * B[k x n]，pa / pb 为调用者提供的打包缓冲区
+void gemm_serial(int m, int n, int k, const float* A, int lda, const float* B, int ldb,
+                 float* C, int ldc, float* pa, float* pb) {
+    for (int jc = 0; jc < n; jc += NC_BLOCK) {
+        int nc = min_int(NC_BLOCK, n - jc);
+        for (int pc = 0; pc < k; pc += KC_BLOCK) {
+            int kc = min_int(KC_BLOCK, k - pc);
+            pack_b(kc, nc, B + (size_t)pc * ldb + jc, ldb, pb);
+            for (int ic = 0; ic < m; ic += MC_BLOCK) {
+                int mc = min_int(MC_BLOCK, m - ic);
+                pack_a(mc, kc, A + (size_t)ic * lda + pc, lda, pa);
+                for (int jr = 0; jr < nc; jr += NR) {
+                    for (int ir = 0; ir < mc; ir += MR) {
+                        micro_kernel(kc, pa + ir * kc, pb + jr * kc,
+                                     C + (size_t)(ic + ir) * ldc + jc + jr, ldc,
+                                     min_int(MR, mc - ir), min_int(NR, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 外积路径：K 很小时直接做 K 次秩一更新，C 只写一遍，不读不打包
+void outer_rows(int i0, int i1, int j0, int j1, int k, const float* A, int lda,
+                const float* B, int ldb, float* C, int ldc) {
+    for (int jb = j0; jb < j1; jb += 256) {
+        int je = min_int(jb + 256, j1);
+        for (int i = i0; i < i1; i++) {
+            const float* a = A + (size_t)i * lda;
+            float* c = C + (size_t)i * ldc;
+            for (int j = jb; j < je; j += 32) {
+                __mmask16 m0 = tail_mask(je - j);
+                __mmask16 m1 = tail_mask(je - j - 16);
+                __m512 c0 = _mm512_setzero_ps();
+                __m512 c1 = _mm512_setzero_ps();
+                for (int p = 0; p < k; p++) {
+                    __m512 av = _mm512_set1_ps(a[p]);
+                    c0 = _mm512_fmadd_ps(av, _mm512_maskz_loadu_ps(m0, B + (size_t)p * ldb + j), c0);
+                    c1 = _mm512_fmadd_ps(av, _mm512_maskz_loadu_ps(m1, B + (size_t)p * ldb + j + 16), c1);
+                }
+                _mm512_mask_storeu_ps(c + j, m0, c0);
+                _mm512_mask_storeu_ps(c + j + 16, m1, c1);
+            }
+        }
+    }
+}
+
+// 估算一个线程网格的耗时 (ns)：最慢线程的计算 + 打包搬运 + split-K 归约
+static double plan_cost(int m, int n, int k, int tm, int tn, int tk, int nthreads) {
+    int mt = ceil_div(ceil_div(m, MR), tm) * MR;
+    int nt = ceil_div(ceil_div(n, NR), tn) * NR;
+    int kt = ceil_div(k, tk);
+    double cost = 2.0 * mt * nt * kt / COST_FLOP_RATE;
+    cost += ((double)mt * kt + (double)kt * nt) * sizeof(float) / COST_MOVE_RATE;
+    if (tk > 1) {
+        cost += (double)m * n * (tk + 1) * sizeof(float) / (COST_MOVE_RATE * nthreads);
+    }
+    return cost;
+}
+
+// 根据形状选择并行划分：遍历所有 tm * tn * tk = nthreads 的网格取代价最小者
+gemm_plan choose_plan(int m, int n, int k, int nthreads) {
+    gemm_plan plan = { PLAN_ROWS, nthreads, 1, 1 };
+
+    if (k <= TINY_K) {
+        plan.kind = PLAN_OUTER;
+        if (m >= n || m >= nthreads * MR) {
+            plan.tm = nthreads;
+        } else {
+            plan.tm = 1;
+            plan.tn = nthreads;
+        }
+        return plan;
+    }
+
+    double best = -1.0;
+    for (int tk = 1; tk <= nthreads; tk++) {
+        if (nthreads % tk) continue;
+        if (tk > 1 && (k / tk < KC_BLOCK / 4 ||
+                       (double)(tk - 1) * m * n * sizeof(float) > SPLIT_K_MAX_BYTES)) continue;
+        int rest = nthreads / tk;
+        for (int tm = 1; tm <= rest; tm++) {
+            if (rest % tm) continue;
+            int tn = rest / tm;
+            double cost = plan_cost(m, n, k, tm, tn, tk, nthreads);
+            if (best < 0.0 || cost < best) {
+                best = cost;
+                plan.tm = tm;
+                plan.tn = tn;
+                plan.tk = tk;
+            }
+        }
+    }
+
+    if (plan.tk > 1) plan.kind = PLAN_SPLIT_K;
+    else if (plan.tn == 1) plan.kind = PLAN_ROWS;
+    else if (plan.tm == 1) plan.kind = PLAN_COLS;
+    else plan.kind = PLAN_GRID;
+    return plan;
+}
+
+// 按计划并行计算 C = A * B
+int gemm_run(const gemm_plan* plan, int m, int n, int k, const float* A, int lda,
+             const float* B, int ldb, float* C, int ldc) {
+    int tm = plan->tm, tn = plan->tn, tk = plan->tk;
+    int nthreads = tm * tn * tk;
+
+    // split-K：第 0 组直接写 C，其余 tk - 1 组各自写一份部分和
+    int ldp = ceil_div(n, 16) * 16;
+    float* partial = NULL;
+    if (tk > 1) {
+        partial = (float*)aligned_alloc(64, sizeof(float) * (size_t)(tk - 1) * m * ldp);
+        if (!partial) return -1;
+    }
+
+    int rows_per = ceil_div(ceil_div(m, MR), tm) * MR;
+    int cols_per = ceil_div(ceil_div(n, NR), tn) * NR;
+    int k_per = ceil_div(k, tk);
+    int failed = 0;
+
+    #pragma omp parallel num_threads(nthreads)
+    {
+        int tid = omp_get_thread_num();
+        int a = tid % tm;
+        int b = (tid / tm) % tn;
+        int c = tid / (tm * tn);
+        int i0 = min_int(m, a * rows_per), i1 = min_int(m, i0 + rows_per);
+        int j0 = min_int(n, b * cols_per), j1 = min_int(n, j0 + cols_per);
+        int k0 = min_int(k, c * k_per), k1 = min_int(k, k0 + k_per);
+
+        if (plan->kind == PLAN_OUTER) {
+            outer_rows(i0, i1, j0, j1, k, A, lda, B, ldb, C, ldc);
+        } else {
+            float* dst = c == 0 ? C : partial + (size_t)(c - 1) * m * ldp;
+            int ldd = c == 0 ? ldc : ldp;
+            for (int i = i0; i < i1; i++) {
+                memset(dst + (size_t)i * ldd + j0, 0, sizeof(float) * (j1 - j0));
+            }
+
+            float* pa = (float*)aligned_alloc(64, sizeof(float) * MC_BLOCK * KC_BLOCK);
+            float* pb = (float*)aligned_alloc(64, sizeof(float) * KC_BLOCK * NC_BLOCK);
+            if (!pa || !pb) {
+                #pragma omp atomic write
+                failed = 1;
+            } else if (i1 > i0 && j1 > j0 && k1 > k0) {
+                gemm_serial(i1 - i0, j1 - j0, k1 - k0,
+                            A + (size_t)i0 * lda + k0, lda,
+                            B + (size_t)k0 * ldb + j0, ldb,
+                            dst + (size_t)i0 * ldd + j0, ldd, pa, pb);
+            }
+            free(pa);
+            free(pb);
+        }
+
+        // 并行向量化归约：按行切分，C += 各组部分和
+        if (tk > 1) {
+            #pragma omp barrier
+            #pragma omp for schedule(static)
+            for (int i = 0; i < m; i++) {
+                float* crow = C + (size_t)i * ldc;
+                for (int j = 0; j < n; j += 16) {
+                    __mmask16 mask = tail_mask(n - j);
+                    __m512 acc = _mm512_maskz_loadu_ps(mask, crow + j);
+                    for (int p = 0; p < tk - 1; p++) {
+                        acc = _mm512_add_ps(acc, _mm512_load_ps(partial + ((size_t)p * m + i) * ldp + j));
+                    }
+                    _mm512_mask_storeu_ps(crow + j, mask, acc);
+                }
+            }
+        }
+    }
+
+    free(partial);
+    return failed ? -1 : 0;
+}
+
+void init_matrix(float* M, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        M[i] = (float)rand() / RAND_MAX * 10.0f;
+    }
+}
+
+// 抽样若干位置与双精度参考值比较，返回最大相对误差
+double check_result(int m, int n, int k, const float* A, const float* B, const float* C) {
+    double max_err = 0.0;
+    for (int s = 0; s < 64; s++) {
+        int i = rand() % m;
+        int j = rand() % n;
+        double ref = 0.0;
+        for (int p = 0; p < k; p++) ref += (double)A[(size_t)i * k + p] * B[(size_t)p * n + j];
+        double err = fabs(C[(size_t)i * n + j] - ref) / (fabs(ref) + 1e-30);
+        if (err > max_err) max_err = err;
+    }
+    return max_err;
+}
+
+double time_plan(const gemm_plan* plan, int m, int n, int k, const float* A, const float* B, float* C) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (gemm_run(plan, m, n, k, A, k, B, n, C, n)) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+void bench_shape(int m, int n, int k, int nthreads) {
+    float* A = (float*)aligned_alloc(64, sizeof(float) * ((size_t)m * k + 16));
+    float* B = (float*)aligned_alloc(64, sizeof(float) * ((size_t)k * n + 16));
+    float* C = (float*)aligned_alloc(64, sizeof(float) * ((size_t)m * n + 16));
+    if (!A || !B || !C) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    init_matrix(A, (size_t)m * k);
+    init_matrix(B, (size_t)k * n);
+
+    double flops = 2.0 * m * n * k;
+    gemm_plan rows = { PLAN_ROWS, nthreads, 1, 1 };
+    gemm_plan plan = choose_plan(m, n, k, nthreads);
+
+    printf("形状: M=%d N=%d K=%d\n", m, n, k);
+
+    double t_rows = time_plan(&rows, m, n, k, A, B, C);
+    printf("  %-10s (%dx%dx%d) 计算时间: %.4f 秒  性能: %.2f GFLOPS  最大相对误差: %.2e\n",
+           "固定按行", rows.tm, rows.tn, rows.tk, t_rows, flops / t_rows / 1e9,
+           check_result(m, n, k, A, B, C));
+
+    double t_plan = time_plan(&plan, m, n, k, A, B, C);
+    printf("  %-10s (%dx%dx%d) 计算时间: %.4f 秒  性能: %.2f GFLOPS  最大相对误差: %.2e\n",
+           plan_name(plan.kind), plan.tm, plan.tn, plan.tk, t_plan, flops / t_plan / 1e9,
+           check_result(m, n, k, A, B, C));
+
+    free(A);
+    free(B);
+    free(C);
+}
+
+int main(int argc, char** argv) {
+    int nthreads = omp_get_max_threads();
+    srand(time(NULL));
+
+    printf("线程数: %d\n", nthreads);
+    if (argc == 4) {
+        bench_shape(atoi(argv[1]), atoi(argv[2]), atoi(argv[3]), nthreads);
+        return 0;
+    }
+
+    // 默认形状：方阵、K 很大、瘦高、矮宽、K 极小
+    static const int shapes[][3] = {
+        { 4096, 4096, 4096 },
+        { 256, 256, 65536 },
+        { 65536, 64, 64 },
+        { 64, 65536, 64 },
+        { 4096, 4096, 8 },
+    };
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        bench_shape(shapes[s][0], shapes[s][1], shapes[s][2], nthreads);
+    }
+    return 0;
+}
@@ -0,0 +1,692 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include <immintrin.h>
+
+// 微内核寄存器分块：MR 行 x NR 列 (2 个 zmm)
+#define MR 8
+#define NR 32
+// 缓存分块：A 块 MC x KC 常驻 L2，B 微面板 KC x NR 常驻 L1
+#define MC_BLOCK 128
+#define KC_BLOCK 256
+#define NC_BLOCK 2048
+// K 不超过该值时走外积路径
+#define TINY_K 16
+#define SPLIT_K_MAX_BYTES (1ul << 30)
+#define COST_FLOP_RATE 100.0
+#define COST_MOVE_RATE 10.0
+
+// 矩阵链最多支持的操作数个数
+#define CHAIN_MAX 32
+// 标定用的探测尺寸：小维度依次取这些值，其余维度固定为 CALIB_BASE
+#define CALIB_POINTS 7
+#define CALIB_BASE 512
+
+typedef enum { PLAN_ROWS, PLAN_COLS, PLAN_GRID, PLAN_SPLIT_K, PLAN_OUTER } plan_kind;
+
+typedef struct {
+    plan_kind kind;
+    int tm, tn, tk;
+} gemm_plan;
+
+// 矩阵链的一个操作数：rows x cols 为逻辑形状 (转置之后)
+// trans 为 1 时 data 按行存放的是 cols x rows 矩阵，乘法时直接按转置读取，不做拷贝
+typedef struct {
+    const float* data;
+    int rows, cols;
+    int ld;
+    int trans;
+} chain_operand;
+
+// 动态规划得到的求值顺序：split[i][j] 为区间 [i, j] 的最优切分点
+typedef struct {
+    int count;
+    int split[CHAIN_MAX][CHAIN_MAX];
+    double cost;
+    size_t workspace;
+} chain_plan;
+
+// 可复用的工作区：线性的一段链在两块缓冲区之间来回交替，只有左右子链都是中间结果时才另开缓冲区
+typedef struct {
+    float* buf;
+    size_t cap;
+} chain_workspace;
+
+// 标定得到的吞吐模型：rate = peak * eff_m(m) * eff_n(n) * eff_k(k)
+typedef struct {
+    int ready;
+    double peak;
+    double overhead;
+    double eff[3][CALIB_POINTS];
+} chain_model;
+
+static const int calib_dims[CALIB_POINTS] = { 4, 8, 16, 32, 64, 128, 256 };
+static chain_model g_model;
+
+static inline int min_int(int a, int b) { return a < b ? a : b; }
+static inline int ceil_div(int a, int b) { return (a + b - 1) / b; }
+
+static inline __mmask16 tail_mask(int n) {
+    if (n >= 16) return 0xFFFF;
+    if (n <= 0) return 0;
+    return (__mmask16)((1u << n) - 1);
+}
+
+// 逻辑位置 (r, c) 在存储中的偏移
+static inline size_t elem_offset(int ld, int trans, int r, int c) {
+    return trans ? (size_t)c * ld + r : (size_t)r * ld + c;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 打包 A 的 mc x kc 块，转置输入时每个 k 的 MR 个元素本身就是连续的
+void pack_a(int mc, int kc, const float* A, int lda, int trans, float* pa) {
+    for (int i = 0; i < mc; i += MR) {
+        int mr = min_int(MR, mc - i);
+        for (int k = 0; k < kc; k++) {
+            if (trans) {
+                for (int r = 0; r < mr; r++) pa[r] = A[(size_t)k * lda + i + r];
+            } else {
+                for (int r = 0; r < mr; r++) pa[r] = A[(size_t)(i + r) * lda + k];
+            }
+            for (int r = mr; r < MR; r++) pa[r] = 0.0f;
+            pa += MR;
+        }
+    }
+}
+
+// 打包 B 的 kc x nc 块，转置输入时逐列收集
+void pack_b(int kc, int nc, const float* B, int ldb, int trans, float* pb) {
+    for (int j = 0; j < nc; j += NR) {
+        int nr = min_int(NR, nc - j);
+        __mmask16 m0 = tail_mask(nr);
+        __mmask16 m1 = tail_mask(nr - 16);
+        for (int k = 0; k < kc; k++) {
+            if (trans) {
+                for (int c = 0; c < nr; c++) pb[c] = B[(size_t)(j + c) * ldb + k];
+                for (int c = nr; c < NR; c++) pb[c] = 0.0f;
+            } else {
+                const float* b = B + (size_t)k * ldb + j;
+                _mm512_store_ps(pb, _mm512_maskz_loadu_ps(m0, b));
+                _mm512_store_ps(pb + 16, _mm512_maskz_loadu_ps(m1, b + 16));
+            }
+            pb += NR;
+        }
+    }
+}
+
+void micro_kernel(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr) {
+    __m512 c0[MR], c1[MR];
+    for (int r = 0; r < MR; r++) {
+        c0[r] = _mm512_setzero_ps();
+        c1[r] = _mm512_setzero_ps();
+    }
+
+    for (int k = 0; k < kc; k++) {
+        __m512 b0 = _mm512_load_ps(pb);
+        __m512 b1 = _mm512_load_ps(pb + 16);
+        for (int r = 0; r < MR; r++) {
+            __m512 a = _mm512_set1_ps(pa[r]);
+            c0[r] = _mm512_fmadd_ps(a, b0, c0[r]);
+            c1[r] = _mm512_fmadd_ps(a, b1, c1[r]);
+        }
+        pa += MR;
+        pb += NR;
+    }
+
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int r = 0; r < mr; r++) {
+        float* c = C + (size_t)r * ldc;
+        _mm512_mask_storeu_ps(c, m0, _mm512_add_ps(c0[r], _mm512_maskz_loadu_ps(m0, c)));
+        _mm512_mask_storeu_ps(c + 16, m1, _mm512_add_ps(c1[r], _mm512_maskz_loadu_ps(m1, c + 16)));
+    }
+}
+
+// 单线程分块 GEMM：C[m x n] += op(A) * op(B)，转置在打包时完成
+void gemm_serial(int m, int n, int k, const float* A, int lda, int transa,
+                 const float* B, int ldb, int transb, float* C, int ldc, float* pa, float* pb) {
+    for (int jc = 0; jc < n; jc += NC_BLOCK) {
+        int nc = min_int(NC_BLOCK, n - jc);
+        for (int pc = 0; pc < k; pc += KC_BLOCK) {
+            int kc = min_int(KC_BLOCK, k - pc);
+            pack_b(kc, nc, B + elem_offset(ldb, transb, pc, jc), ldb, transb, pb);
+            for (int ic = 0; ic < m; ic += MC_BLOCK) {
+                int mc = min_int(MC_BLOCK, m - ic);
+                pack_a(mc, kc, A + elem_offset(lda, transa, ic, pc), lda, transa, pa);
+                for (int jr = 0; jr < nc; jr += NR) {
+                    for (int ir = 0; ir < mc; ir += MR) {
+                        micro_kernel(kc, pa + ir * kc, pb + jr * kc,
+                                     C + (size_t)(ic + ir) * ldc + jc + jr, ldc,
+                                     min_int(MR, mc - ir), min_int(NR, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 外积路径 (仅用于不转置的输入)
+void outer_rows(int i0, int i1, int j0, int j1, int k, const float* A, int lda,
+                const float* B, int ldb, float* C, int ldc) {
+    for (int jb = j0; jb < j1; jb += 256) {
+        int je = min_int(jb + 256, j1);
+        for (int i = i0; i < i1; i++) {
+            const float* a = A + (size_t)i * lda;
+            float* c = C + (size_t)i * ldc;
+            for (int j = jb; j < je; j += 32) {
+                __mmask16 m0 = tail_mask(je - j);
+                __mmask16 m1 = tail_mask(je - j - 16);
+                __m512 c0 = _mm512_setzero_ps();
+                __m512 c1 = _mm512_setzero_ps();
+                for (int p = 0; p < k; p++) {
+                    __m512 av = _mm512_set1_ps(a[p]);
+                    c0 = _mm512_fmadd_ps(av, _mm512_maskz_loadu_ps(m0, B + (size_t)p * ldb + j), c0);
+                    c1 = _mm512_fmadd_ps(av, _mm512_maskz_loadu_ps(m1, B + (size_t)p * ldb + j + 16), c1);
+                }
+                _mm512_mask_storeu_ps(c + j, m0, c0);
+                _mm512_mask_storeu_ps(c + j + 16, m1, c1);
+            }
+        }
+    }
+}
+
+static double plan_cost(int m, int n, int k, int tm, int tn, int tk, int nthreads) {
+    int mt = ceil_div(ceil_div(m, MR), tm) * MR;
+    int nt = ceil_div(ceil_div(n, NR), tn) * NR;
+    int kt = ceil_div(k, tk);
+    double cost = 2.0 * mt * nt * kt / COST_FLOP_RATE;
+    cost += ((double)mt * kt + (double)kt * nt) * sizeof(float) / COST_MOVE_RATE;
+    if (tk > 1) {
+        cost += (double)m * n * (tk + 1) * sizeof(float) / (COST_MOVE_RATE * nthreads);
+    }
+    return cost;
+}
+
+gemm_plan choose_plan(int m, int n, int k, int transa, int transb, int nthreads) {
+    gemm_plan plan = { PLAN_ROWS, nthreads, 1, 1 };
+
+    if (k <= TINY_K && !transa && !transb) {
+        plan.kind = PLAN_OUTER;
+        if (m >= n || m >= nthreads * MR) {
+            plan.tm = nthreads;
+        } else {
+            plan.tm = 1;
+            plan.tn = nthreads;
+        }
+        return plan;
+    }
+
+    double best = -1.0;
+    for (int tk = 1; tk <= nthreads; tk++) {
+        if (nthreads % tk) continue;
+        if (tk > 1 && (k / tk < KC_BLOCK / 4 ||
+                       (double)(tk - 1) * m * n * sizeof(float) > SPLIT_K_MAX_BYTES)) continue;
+        int rest = nthreads / tk;
+        for (int tm = 1; tm <= rest; tm++) {
+            if (rest % tm) continue;
+            int tn = rest / tm;
+            double cost = plan_cost(m, n, k, tm, tn, tk, nthreads);
+            if (best < 0.0 || cost < best) {
+                best = cost;
+                plan.tm = tm;
+                plan.tn = tn;
+                plan.tk = tk;
+            }
+        }
+    }
+
+    if (plan.tk > 1) plan.kind = PLAN_SPLIT_K;
+    else if (plan.tn == 1) plan.kind = PLAN_ROWS;
+    else if (plan.tm == 1) plan.kind = PLAN_COLS;
+    else plan.kind = PLAN_GRID;
+    return plan;
+}
+
+// 按计划并行计算 C = op(A) * op(B)
+int gemm_run(const gemm_plan* plan, int m, int n, int k, const float* A, int lda, int transa,
+             const float* B, int ldb, int transb, float* C, int ldc) {
+    int tm = plan->tm, tn = plan->tn, tk = plan->tk;
+    int nthreads = tm * tn * tk;
+
+    int ldp = ceil_div(n, 16) * 16;
+    float* partial = NULL;
+    if (tk > 1) {
+        partial = (float*)aligned_alloc(64, sizeof(float) * (size_t)(tk - 1) * m * ldp);
+        if (!partial) return -1;
+    }
+
+    int rows_per = ceil_div(ceil_div(m, MR), tm) * MR;
+    int cols_per = ceil_div(ceil_div(n, NR), tn) * NR;
+    int k_per = ceil_div(k, tk);
+    int failed = 0;
+
+    #pragma omp parallel num_threads(nthreads)
+    {
+        int tid = omp_get_thread_num();
+        int a = tid % tm;
+        int b = (tid / tm) % tn;
+        int c = tid / (tm * tn);
+        int i0 = min_int(m, a * rows_per), i1 = min_int(m, i0 + rows_per);
+        int j0 = min_int(n, b * cols_per), j1 = min_int(n, j0 + cols_per);
+        int k0 = min_int(k, c * k_per), k1 = min_int(k, k0 + k_per);
+
+        if (plan->kind == PLAN_OUTER) {
+            outer_rows(i0, i1, j0, j1, k, A, lda, B, ldb, C, ldc);
+        } else {
+            float* dst = c == 0 ? C : partial + (size_t)(c - 1) * m * ldp;
+            int ldd = c == 0 ? ldc : ldp;
+            for (int i = i0; i < i1; i++) {
+                memset(dst + (size_t)i * ldd + j0, 0, sizeof(float) * (j1 - j0));
+            }
+
+            float* pa = (float*)aligned_alloc(64, sizeof(float) * MC_BLOCK * KC_BLOCK);
+            float* pb = (float*)aligned_alloc(64, sizeof(float) * KC_BLOCK * NC_BLOCK);
+            if (!pa || !pb) {
+                #pragma omp atomic write
+                failed = 1;
+            } else if (i1 > i0 && j1 > j0 && k1 > k0) {
+                gemm_serial(i1 - i0, j1 - j0, k1 - k0,
+                            A + elem_offset(lda, transa, i0, k0), lda, transa,
+                            B + elem_offset(ldb, transb, k0, j0), ldb, transb,
+                            dst + (size_t)i0 * ldd + j0, ldd, pa, pb);
+            }
+            free(pa);
+            free(pb);
+        }
+
+        if (tk > 1) {
+            #pragma omp barrier
+            #pragma omp for schedule(static)
+            for (int i = 0; i < m; i++) {
+                float* crow = C + (size_t)i * ldc;
+                for (int j = 0; j < n; j += 16) {
+                    __mmask16 mask = tail_mask(n - j);
+                    __m512 acc = _mm512_maskz_loadu_ps(mask, crow + j);
+                    for (int p = 0; p < tk - 1; p++) {
+                        acc = _mm512_add_ps(acc, _mm512_load_ps(partial + ((size_t)p * m + i) * ldp + j));
+                    }
+                    _mm512_mask_storeu_ps(crow + j, mask, acc);
+                }
+            }
+        }
+    }
+
+    free(partial);
+    return failed ? -1 : 0;
+}
+
+int gemm(int m, int n, int k, const float* A, int lda, int transa,
+         const float* B, int ldb, int transb, float* C, int ldc) {
+    gemm_plan plan = choose_plan(m, n, k, transa, transb, omp_get_max_threads());
+    return gemm_run(&plan, m, n, k, A, lda, transa, B, ldb, transb, C, ldc);
+}
+
+// 测一次 m x n x k 乘法的最短耗时 (秒)
+static double probe_gemm(int m, int n, int k, float* A, float* B, float* C) {
+    double best = 1e30;
+    for (int rep = 0; rep < 3; rep++) {
+        double t0 = now_sec();
+        gemm(m, n, k, A, k, 0, B, n, 0, C, n);
+        double t = now_sec() - t0;
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+// 用实测吞吐标定代价模型：分别让 M、N、K 取小值，得到每个维度的效率曲线
+int chain_calibrate(void) {
+    if (g_model.ready) return 0;
+
+    size_t count = (size_t)CALIB_BASE * CALIB_BASE;
+    float* A = (float*)aligned_alloc(64, sizeof(float) * count);
+    float* B = (float*)aligned_alloc(64, sizeof(float) * count);
+    float* C = (float*)aligned_alloc(64, sizeof(float) * count);
+    if (!A || !B || !C) {
+        free(A);
+        free(B);
+        free(C);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        A[i] = 1.0f;
+        B[i] = 1.0f;
+    }
+
+    double base = CALIB_BASE;
+    g_model.peak = 2.0 * base * base * base / probe_gemm(CALIB_BASE, CALIB_BASE, CALIB_BASE, A, B, C);
+    g_model.overhead = probe_gemm(1, 1, 1, A, B, C);
+    for (int p = 0; p < CALIB_POINTS; p++) {
+        int d = calib_dims[p];
+        double flops = 2.0 * d * base * base;
+        g_model.eff[0][p] = flops / probe_gemm(d, CALIB_BASE, CALIB_BASE, A, B, C) / g_model.peak;
+        g_model.eff[1][p] = flops / probe_gemm(CALIB_BASE, d, CALIB_BASE, A, B, C) / g_model.peak;
+        g_model.eff[2][p] = flops / probe_gemm(CALIB_BASE, CALIB_BASE, d, A, B, C) / g_model.peak;
+    }
+    g_model.ready = 1;
+
+    free(A);
+    free(B);
+    free(C);
+    return 0;
+}
+
+// 某个维度取值 d 时的效率，在探测点之间按 log(d) 线性插值
+static double dim_efficiency(int axis, int d) {
+    if (d <= calib_dims[0]) return g_model.eff[axis][0] * d / calib_dims[0];
+    for (int p = 1; p < CALIB_POINTS; p++) {
+        if (d <= calib_dims[p]) {
+            double t = log((double)d / calib_dims[p - 1]) / log((double)calib_dims[p] / calib_dims[p - 1]);
+            return g_model.eff[axis][p - 1] + t * (g_model.eff[axis][p] - g_model.eff[axis][p - 1]);
+        }
+    }
+    double e = g_model.eff[axis][CALIB_POINTS - 1];
+    return e + (1.0 - e) * (1.0 - (double)calib_dims[CALIB_POINTS - 1] / d);
+}
+
+// 预测一次乘法的耗时 (秒)；未标定时退化为纯 FLOP 计数
+double gemm_cost(int m, int n, int k, int calibrated) {
+    double flops = 2.0 * m * n * k;
+    if (!calibrated) return flops;
+    double eff = dim_efficiency(0, m) * dim_efficiency(1, n) * dim_efficiency(2, k);
+    if (eff < 1e-3) eff = 1e-3;
+    return g_model.overhead + flops / (g_model.peak * eff);
+}
+
+static inline size_t round_up16(size_t n) { return (n + 15) & ~(size_t)15; }
+
+// 工作区里的一块缓冲区：off 为起始位置，cap 为容量 (float 个数)，cap 为 0 表示不可借用 (调用者的输出)
+typedef struct {
+    size_t off;
+    size_t cap;
+} ws_slot;
+
+static inline size_t chain_size(const chain_operand* ops, int i, int j) {
+    return round_up16((size_t)ops[i].rows * ops[j].cols);
+}
+
+// 从区间 [i, j] 开始的线性段 (每层只有一侧是中间结果) 里会落在同一块缓冲区的中间结果的最大值：
+// 交替之后隔一层才回到同一块，所以 own 为 1 时计入本层，往下一层取反
+static size_t chain_run_max(const chain_operand* ops, const chain_plan* plan, int i, int j, int own) {
+    size_t size = own ? chain_size(ops, i, j) : 0;
+    int s = plan->split[i][j];
+    size_t below = 0;
+    if (s > i && j == s + 1) below = chain_run_max(ops, plan, i, s, !own);
+    if (s == i && j > s + 1) below = chain_run_max(ops, plan, s + 1, j, !own);
+    return size > below ? size : below;
+}
+
+// 按计划求区间 [i, j]，结果写入 dst (工作区中的 self 槽，或调用者的输出)
+// spare 是一块此刻空闲、可以覆盖的缓冲区：只有一侧是中间结果时写进 spare，子链再把 self 当作 spare，
+// 于是线性段在两块缓冲区之间交替；spare 放不下或两侧都要同时保留时才从 top 往上新开，
+// 新开的按线性段里之后会轮到这块的中间结果的最大值分配。
+// run 为 0 时只统计峰值，不做计算
+static int chain_walk(const chain_operand* ops, const chain_plan* plan, int i, int j, int run, float* ws,
+                      size_t top, size_t* peak, float* dst, int ldd, ws_slot self, ws_slot spare) {
+    if (top > *peak) *peak = top;
+    int s = plan->split[i][j];
+    int left_mid = s > i, right_mid = j > s + 1;
+    chain_operand left = ops[i], right = ops[j];
+    ws_slot ls = {0, 0}, rs = {0, 0};
+
+    if (left_mid && right_mid) {
+        // 左结果要在右子链求值期间保留：左边优先借用 spare，右边总是新开
+        if (spare.cap >= chain_size(ops, i, s)) {
+            ls = spare;
+        } else {
+            ls.off = top;
+            ls.cap = chain_run_max(ops, plan, i, s, 1);
+            top += ls.cap;
+        }
+        rs.off = top;
+        rs.cap = chain_run_max(ops, plan, s + 1, j, 1);
+    } else if (left_mid || right_mid) {
+        int a = left_mid ? i : s + 1, b = left_mid ? s : j;
+        ws_slot* cs = left_mid ? &ls : &rs;
+        if (spare.cap >= chain_size(ops, a, b)) {
+            *cs = spare;
+        } else {
+            cs->off = top;
+            cs->cap = chain_run_max(ops, plan, a, b, 1);
+            top += cs->cap;
+        }
+    }
+
+    if (left_mid) {
+        left.data = run ? ws + ls.off : NULL;
+        left.cols = ops[s].cols;
+        left.ld = left.cols;
+        left.trans = 0;
+        if (chain_walk(ops, plan, i, s, run, ws, top, peak, (float*)left.data, left.ld, ls, self)) return -1;
+    }
+    if (right_mid) {
+        right.data = run ? ws + rs.off : NULL;
+        right.rows = ops[s + 1].rows;
+        right.ld = right.cols;
+        right.trans = 0;
+        size_t rtop = left_mid ? rs.off + rs.cap : top;
+        if (chain_walk(ops, plan, s + 1, j, run, ws, rtop, peak, (float*)right.data, right.ld, rs, self)) return -1;
+    }
+    if (!run) return 0;
+    return gemm(left.rows, right.cols, left.cols, left.data, left.ld, left.trans,
+                right.data, right.ld, right.trans, dst, ldd);
+}
+
+// 整条链求值时在工作区中占用的峰值 (float 个数)
+static size_t chain_need(const chain_operand* ops, const chain_plan* plan) {
+    if (plan->count < 2) return 0;
+    size_t peak = 0;
+    ws_slot none = {0, 0};
+    chain_walk(ops, plan, 0, plan->count - 1, 0, NULL, 0, &peak, NULL, 0, none, none);
+    return peak;
+}
+
+// 动态规划求最优括号化，calibrated 为 1 时使用标定后的代价模型
+int chain_plan_build(const chain_operand* ops, int count, int calibrated, chain_plan* plan) {
+    double cost[CHAIN_MAX][CHAIN_MAX] = {{0.0}};  // 8 KB，放在栈上保证可重入
+
+    if (count < 1 || count > CHAIN_MAX) return -1;
+    for (int i = 0; i + 1 < count; i++) {
+        if (ops[i].cols != ops[i + 1].rows) return -1;
+    }
+    if (calibrated && chain_calibrate()) return -1;
+
+    plan->count = count;
+    for (int i = 0; i < count; i++) cost[i][i] = 0.0;
+    for (int len = 2; len <= count; len++) {
+        for (int i = 0; i + len - 1 < count; i++) {
+            int j = i + len - 1;
+            cost[i][j] = -1.0;
+            for (int s = i; s < j; s++) {
+                double c = cost[i][s] + cost[s + 1][j] +
+                           gemm_cost(ops[i].rows, ops[j].cols, ops[s].cols, calibrated);
+                if (cost[i][j] < 0.0 || c < cost[i][j]) {
+                    cost[i][j] = c;
+                    plan->split[i][j] = s;
+                }
+            }
+        }
+    }
+    plan->cost = cost[0][count - 1];
+    plan->workspace = chain_need(ops, plan);
+    return 0;
+}
+
+// 从左到右依次相乘的朴素顺序，用作对照
+void chain_plan_left_to_right(const chain_operand* ops, int count, chain_plan* plan) {
+    plan->count = count;
+    plan->cost = 0.0;
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) plan->split[i][j] = j - 1;
+    }
+    plan->workspace = chain_need(ops, plan);
+}
+
+// 按给定顺序累计代价，用来在同一模型下比较不同的计划
+double chain_plan_cost(const chain_operand* ops, const chain_plan* plan, int i, int j, int calibrated) {
+    if (i == j) return 0.0;
+    int s = plan->split[i][j];
+    return chain_plan_cost(ops, plan, i, s, calibrated) + chain_plan_cost(ops, plan, s + 1, j, calibrated) +
+           gemm_cost(ops[i].rows, ops[j].cols, ops[s].cols, calibrated);
+}
+
+void chain_plan_print(const chain_plan* plan, int i, int j) {
+    if (i == j) {
+        printf("M%d", i);
+        return;
+    }
+    printf("(");
+    chain_plan_print(plan, i, plan->split[i][j]);
+    printf(" ");
+    chain_plan_print(plan, plan->split[i][j] + 1, j);
+    printf(")");
+}
+
+// 按计划计算整条链，结果写入 out (rows(M0) x cols(Mn-1))；工作区不够时才扩容
+int chain_multiply(const chain_operand* ops, const chain_plan* plan, chain_workspace* ws,
+                   float* out, int ldo) {
+    int count = plan->count;
+    if (count == 1) {
+        for (int r = 0; r < ops[0].rows; r++) {
+            for (int c = 0; c < ops[0].cols; c++) {
+                out[(size_t)r * ldo + c] = ops[0].data[elem_offset(ops[0].ld, ops[0].trans, r, c)];
+            }
+        }
+        return 0;
+    }
+    if (ws->cap < plan->workspace) {
+        free(ws->buf);
+        ws->buf = (float*)aligned_alloc(64, sizeof(float) * plan->workspace);
+        ws->cap = ws->buf ? plan->workspace : 0;
+        if (!ws->buf) return -1;
+    }
+    size_t peak = 0;
+    ws_slot none = {0, 0};
+    return chain_walk(ops, plan, 0, count - 1, 1, ws->buf, 0, &peak, out, ldo, none, none);
+}
+
+void init_matrix(float* M, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        M[i] = (float)rand() / RAND_MAX;
+    }
+}
+
+// 用双精度逐个操作数乘出结果的第 r 行，抽样检查
+double check_row(const chain_operand* ops, int count, const float* out, int ldo, int r) {
+    int width = ops[0].cols;
+    double* row = (double*)malloc(sizeof(double) * width);
+    for (int c = 0; c < width; c++) row[c] = ops[0].data[elem_offset(ops[0].ld, ops[0].trans, r, c)];
+    for (int t = 1; t < count; t++) {
+        double* next = (double*)calloc(ops[t].cols, sizeof(double));
+        for (int p = 0; p < ops[t].rows; p++) {
+            for (int c = 0; c < ops[t].cols; c++) {
+                next[c] += row[p] * ops[t].data[elem_offset(ops[t].ld, ops[t].trans, p, c)];
+            }
+        }
+        free(row);
+        row = next;
+        width = ops[t].cols;
+    }
+    double max_err = 0.0;
+    for (int c = 0; c < width; c++) {
+        double err = fabs(out[(size_t)r * ldo + c] - row[c]) / (fabs(row[c]) + 1e-30);
+        if (err > max_err) max_err = err;
+    }
+    free(row);
+    return max_err;
+}
+
+void bench_chain(const char* name, const int* dims, const int* trans, int count) {
+    chain_operand ops[CHAIN_MAX];
+    float* data[CHAIN_MAX];
+
+    printf("链: %s\n", name);
+    for (int i = 0; i < count; i++) {
+        size_t size = (size_t)dims[i] * dims[i + 1];
+        data[i] = (float*)aligned_alloc(64, sizeof(float) * round_up16(size));
+        if (!data[i]) {
+            fprintf(stderr, "内存分配失败\n");
+            exit(EXIT_FAILURE);
+        }
+        init_matrix(data[i], size);
+        ops[i].data = data[i];
+        ops[i].rows = dims[i];
+        ops[i].cols = dims[i + 1];
+        ops[i].trans = trans[i];
+        ops[i].ld = trans[i] ? dims[i] : dims[i + 1];
+        printf("  M%d: %d x %d%s\n", i, dims[i], dims[i + 1], trans[i] ? " (转置存放)" : "");
+    }
+
+    int rows = dims[0], cols = dims[count];
+    float* out = (float*)aligned_alloc(64, sizeof(float) * round_up16((size_t)rows * cols));
+    if (!out) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+
+    chain_plan plans[3];
+    const char* labels[3] = { "从左到右", "FLOP 最优", "标定最优" };
+    chain_plan_left_to_right(ops, count, &plans[0]);
+    chain_plan_build(ops, count, 0, &plans[1]);
+    chain_plan_build(ops, count, 1, &plans[2]);
+
+    chain_workspace ws = { NULL, 0 };
+    for (int p = 0; p < 3; p++) {
+        double t0 = now_sec();
+        if (chain_multiply(ops, &plans[p], &ws, out, cols)) {
+            fprintf(stderr, "内存分配失败\n");
+            exit(EXIT_FAILURE);
+        }
+        double t = now_sec() - t0;
+
+        printf("  %-12s ", labels[p]);
+        chain_plan_print(&plans[p], 0, count - 1);
+        printf("\n    FLOP: %.3g  预测耗时: %.4f 秒  工作区: %.2f MB  计算时间: %.4f 秒  最大相对误差: %.2e\n",
+               chain_plan_cost(ops, &plans[p], 0, count - 1, 0), chain_plan_cost(ops, &plans[p], 0, count - 1, 1),
+               plans[p].workspace * sizeof(float) / 1048576.0, t, check_row(ops, count, out, cols, rand() % rows));
+    }
+
+    // 重复调用：工作区已经足够，不再分配
+    double t0 = now_sec();
+    for (int rep = 0; rep < 5; rep++) chain_multiply(ops, &plans[2], &ws, out, cols);
+    printf("  复用工作区重复 5 次平均: %.4f 秒\n", (now_sec() - t0) / 5);
+
+    free(ws.buf);
+    free(out);
+    for (int i = 0; i < count; i++) free(data[i]);
+}
+
+int main() {
+    srand(time(NULL));
+
+    double t0 = now_sec();
+    if (chain_calibrate()) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("线程数: %d\n", omp_get_max_threads());
+    printf("标定耗时: %.4f 秒  峰值: %.2f GFLOPS  单次调用开销: %.2f 微秒\n",
+           now_sec() - t0, g_model.peak / 1e9, g_model.overhead * 1e6);
+    printf("维度效率 (M / N / K):\n");
+    for (int p = 0; p < CALIB_POINTS; p++) {
+        printf("  %4d: %.2f / %.2f / %.2f\n", calib_dims[p],
+               g_model.eff[0][p], g_model.eff[1][p], g_model.eff[2][p]);
+    }
+
+    static const int dims1[] = { 4096, 64, 4096, 4096, 64 };
+    static const int trans1[] = { 0, 0, 0, 0 };
+    bench_chain("A B C D", dims1, trans1, 4);
+
+    static const int dims2[] = { 1024, 2048, 32, 2048, 1024, 8 };
+    static const int trans2[] = { 1, 0, 1, 0, 0 };
+    bench_chain("A^T B C^T D E", dims2, trans2, 5);
+
+    return 0;
+}
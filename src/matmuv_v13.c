@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include <immintrin.h>
+
+// 分块边长：一个块 TILE x TILE 在块内按行存放，块与块之间按 Z 序 (Morton 序) 排列
+#define TILE 64
+#define TILE_ELEMS (TILE * TILE)
+// 叶子内核的寄存器分块：8 行 x 32 列
+#define LEAF_MR 8
+// 递归时子问题的块数不低于该值才派生任务
+#define TASK_CUTOFF 64
+
+// Z 序存储的矩阵：逻辑形状 rows x cols，块网格 trows x tcols
+// 较短一边补齐到 2^bits 块后与较长一边的低位交错，多出的高位直接拼接，
+// 相当于一排 2^bits x 2^bits 的 Z 序方块，细长矩阵也不会浪费太多空间
+typedef struct {
+    int rows, cols;
+    int trows, tcols;
+    int bits;
+    size_t ntiles;
+    float* data;
+} morton_matrix;
+
+static inline int min_int(int a, int b) { return a < b ? a : b; }
+static inline int ceil_div(int a, int b) { return (a + b - 1) / b; }
+
+static inline __mmask16 tail_mask(int n) {
+    if (n >= 16) return 0xFFFF;
+    if (n <= 0) return 0;
+    return (__mmask16)((1u << n) - 1);
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 把 16 位整数的各位分散到偶数位上
+static inline uint32_t spread_bits(uint32_t x) {
+    x &= 0xFFFF;
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+// 块 (ti, tj) 在存储中的序号
+static inline size_t morton_index(const morton_matrix* M, int ti, int tj) {
+    uint32_t low = (1u << M->bits) - 1;
+    size_t z = spread_bits(tj & low) | (spread_bits(ti & low) << 1);
+    size_t high = M->trows > M->tcols ? (size_t)(ti >> M->bits) : (size_t)(tj >> M->bits);
+    return (high << (2 * M->bits)) | z;
+}
+
+static inline float* tile_at(const morton_matrix* M, int ti, int tj) {
+    return M->data + morton_index(M, ti, tj) * TILE_ELEMS;
+}
+
+int morton_create(morton_matrix* M, int rows, int cols) {
+    M->rows = rows;
+    M->cols = cols;
+    M->trows = ceil_div(rows, TILE);
+    M->tcols = ceil_div(cols, TILE);
+    M->bits = 0;
+    while ((1 << M->bits) < min_int(M->trows, M->tcols)) M->bits++;
+    M->ntiles = morton_index(M, M->trows - 1, M->tcols - 1) + 1;
+    M->data = (float*)aligned_alloc(64, sizeof(float) * M->ntiles * TILE_ELEMS);
+    return M->data ? 0 : -1;
+}
+
+void morton_destroy(morton_matrix* M) {
+    free(M->data);
+    M->data = NULL;
+}
+
+// 行主序 -> Z 序，边缘块补零
+void morton_from_rowmajor(morton_matrix* M, const float* src, int ld) {
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (int ti = 0; ti < M->trows; ti++) {
+        for (int tj = 0; tj < M->tcols; tj++) {
+            float* t = tile_at(M, ti, tj);
+            int nr = min_int(TILE, M->rows - ti * TILE);
+            int nc = min_int(TILE, M->cols - tj * TILE);
+            for (int r = 0; r < TILE; r++) {
+                const float* s = src + (size_t)(ti * TILE + r) * ld + tj * TILE;
+                for (int c = 0; c < TILE; c += 16) {
+                    __mmask16 mask = r < nr ? tail_mask(nc - c) : 0;
+                    _mm512_store_ps(t + r * TILE + c, _mm512_maskz_loadu_ps(mask, s + c));
+                }
+            }
+        }
+    }
+}
+
+// Z 序 -> 行主序，只写回有效区域
+void morton_to_rowmajor(const morton_matrix* M, float* dst, int ld) {
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (int ti = 0; ti < M->trows; ti++) {
+        for (int tj = 0; tj < M->tcols; tj++) {
+            const float* t = tile_at(M, ti, tj);
+            int nr = min_int(TILE, M->rows - ti * TILE);
+            int nc = min_int(TILE, M->cols - tj * TILE);
+            for (int r = 0; r < nr; r++) {
+                float* d = dst + (size_t)(ti * TILE + r) * ld + tj * TILE;
+                for (int c = 0; c < nc; c += 16) {
+                    _mm512_mask_storeu_ps(d + c, tail_mask(nc - c), _mm512_load_ps(t + r * TILE + c));
+                }
+            }
+        }
+    }
+}
+
+// 叶子内核：C 块 += A 块 * B 块，三个块合计 48KB，正好落在 L1 里
+static void leaf_kernel(const float* a, const float* b, float* c) {
+    for (int i = 0; i < TILE; i += LEAF_MR) {
+        for (int j = 0; j < TILE; j += 32) {
+            __m512 c0[LEAF_MR], c1[LEAF_MR];
+            for (int r = 0; r < LEAF_MR; r++) {
+                c0[r] = _mm512_load_ps(c + (i + r) * TILE + j);
+                c1[r] = _mm512_load_ps(c + (i + r) * TILE + j + 16);
+            }
+            for (int k = 0; k < TILE; k++) {
+                __m512 b0 = _mm512_load_ps(b + k * TILE + j);
+                __m512 b1 = _mm512_load_ps(b + k * TILE + j + 16);
+                for (int r = 0; r < LEAF_MR; r++) {
+                    __m512 av = _mm512_set1_ps(a[(i + r) * TILE + k]);
+                    c0[r] = _mm512_fmadd_ps(av, b0, c0[r]);
+                    c1[r] = _mm512_fmadd_ps(av, b1, c1[r]);
+                }
+            }
+            for (int r = 0; r < LEAF_MR; r++) {
+                _mm512_store_ps(c + (i + r) * TILE + j, c0[r]);
+                _mm512_store_ps(c + (i + r) * TILE + j + 16, c1[r]);
+            }
+        }
+    }
+}
+
+// 缓存无关递归：每次把 m / n / k 中最大的一维对半切，直到只剩一个块
+// 切 m 或 n 得到的两半互不相干，可以并行；切 k 的两半写同一块 C，只能串行
+static void morton_rec(const morton_matrix* A, const morton_matrix* B, morton_matrix* C,
+                       int i0, int j0, int k0, int m, int n, int k) {
+    if (m == 1 && n == 1 && k == 1) {
+        leaf_kernel(tile_at(A, i0, k0), tile_at(B, k0, j0), tile_at(C, i0, j0));
+        return;
+    }
+
+    int spawn = (long)m * n * k >= TASK_CUTOFF;
+    if (m >= n && m >= k) {
+        int h = m / 2;
+        #pragma omp task if(spawn)
+        morton_rec(A, B, C, i0, j0, k0, h, n, k);
+        morton_rec(A, B, C, i0 + h, j0, k0, m - h, n, k);
+        #pragma omp taskwait
+    } else if (n >= k) {
+        int h = n / 2;
+        #pragma omp task if(spawn)
+        morton_rec(A, B, C, i0, j0, k0, m, h, k);
+        morton_rec(A, B, C, i0, j0 + h, k0, m, n - h, k);
+        #pragma omp taskwait
+    } else {
+        int h = k / 2;
+        morton_rec(A, B, C, i0, j0, k0, m, n, h);
+        morton_rec(A, B, C, i0, j0, k0 + h, m, n, k - h);
+    }
+}
+
+// C = A * B，三个矩阵都是 Z 序存储
+int morton_gemm(const morton_matrix* A, const morton_matrix* B, morton_matrix* C) {
+    if (A->cols != B->rows || C->rows != A->rows || C->cols != B->cols) return -1;
+    memset(C->data, 0, sizeof(float) * C->ntiles * TILE_ELEMS);
+
+    #pragma omp parallel
+    #pragma omp single
+    morton_rec(A, B, C, 0, 0, 0, C->trows, C->tcols, A->tcols);
+    return 0;
+}
+
+void init_matrix(float* M, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        M[i] = (float)rand() / RAND_MAX * 10.0f;
+    }
+}
+
+double check_result(int m, int n, int k, const float* A, const float* B, const float* C) {
+    double max_err = 0.0;
+    for (int s = 0; s < 64; s++) {
+        int i = rand() % m;
+        int j = rand() % n;
+        double ref = 0.0;
+        for (int p = 0; p < k; p++) ref += (double)A[(size_t)i * k + p] * B[(size_t)p * n + j];
+        double err = fabs(C[(size_t)i * n + j] - ref) / (fabs(ref) + 1e-30);
+        if (err > max_err) max_err = err;
+    }
+    return max_err;
+}
+
+void bench_shape(int m, int n, int k) {
+    float* A = (float*)aligned_alloc(64, sizeof(float) * ((size_t)m * k + 16));
+    float* B = (float*)aligned_alloc(64, sizeof(float) * ((size_t)k * n + 16));
+    float* C = (float*)aligned_alloc(64, sizeof(float) * ((size_t)m * n + 16));
+    morton_matrix ZA, ZB, ZC;
+    if (!A || !B || !C || morton_create(&ZA, m, k) || morton_create(&ZB, k, n) || morton_create(&ZC, m, n)) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    init_matrix(A, (size_t)m * k);
+    init_matrix(B, (size_t)k * n);
+
+    double t0 = now_sec();
+    morton_from_rowmajor(&ZA, A, k);
+    morton_from_rowmajor(&ZB, B, n);
+    double t_in = now_sec() - t0;
+
+    t0 = now_sec();
+    morton_gemm(&ZA, &ZB, &ZC);
+    double t_mul = now_sec() - t0;
+
+    t0 = now_sec();
+    morton_to_rowmajor(&ZC, C, n);
+    double t_out = now_sec() - t0;
+
+    double flops = 2.0 * m * n * k;
+    size_t padded = (ZA.ntiles + ZB.ntiles + ZC.ntiles) * TILE_ELEMS;
+    size_t dense = (size_t)m * k + (size_t)k * n + (size_t)m * n;
+    printf("形状: M=%d N=%d K=%d  块大小: %d  Z 序存储开销: %.2fx\n", m, n, k, TILE, (double)padded / dense);
+    printf("  转换 (行主序->Z 序): %.4f 秒\n", t_in);
+    printf("  计算时间: %.4f 秒  性能: %.2f GFLOPS\n", t_mul, flops / t_mul / 1e9);
+    printf("  转换 (Z 序->行主序): %.4f 秒\n", t_out);
+    printf("  含转换总性能: %.2f GFLOPS  最大相对误差: %.2e\n",
+           flops / (t_in + t_mul + t_out) / 1e9, check_result(m, n, k, A, B, C));
+
+    morton_destroy(&ZA);
+    morton_destroy(&ZB);
+    morton_destroy(&ZC);
+    free(A);
+    free(B);
+    free(C);
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    printf("线程数: %d\n", omp_get_max_threads());
+
+    if (argc == 4) {
+        bench_shape(atoi(argv[1]), atoi(argv[2]), atoi(argv[3]));
+        return 0;
+    }
+
+    bench_shape(4096, 4096, 4096);
+    bench_shape(3000, 2000, 1000);
+    bench_shape(256, 8192, 512);
+    return 0;
+}
@@ -0,0 +1,510 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include <immintrin.h>
+
+// 微内核寄存器分块：MR 行 x NR 列 (2 个 zmm)
+#define MR 8
+#define NR 32
+// 缓存分块：A 块 MC x KC 常驻 L2，B 微面板 KC x NR 常驻 L1
+#define MC_BLOCK 128
+#define KC_BLOCK 256
+#define NC_BLOCK 2048
+#define COST_FLOP_RATE 100.0
+#define COST_MOVE_RATE 10.0
+
+typedef enum { LAYOUT_NCHW, LAYOUT_NHWC } conv_layout;
+
+// 二维卷积参数
+// NCHW：输入 N x C x H x W，权重 OIHW，输出 N x OC x OH x OW
+// NHWC：输入 N x H x W x C，权重 HWIO，输出 N x OH x OW x OC
+typedef struct {
+    conv_layout layout;
+    int n, c, h, w;
+    int oc, kh, kw;
+    int stride_h, stride_w;
+    int pad_h, pad_w;
+    int dil_h, dil_w;
+    int oh, ow;
+} conv_params;
+
+// 隐式 im2col 矩阵：每个补丁 (输出像素) 是一行或一列，每个 k 对应 (c, kh, kw) 中的一个抽头
+// dy / dx / off 按 k 预先算好，打包时直接从输入张量里按补丁收集，不生成 im2col 缓冲区
+typedef struct {
+    const conv_params* p;
+    int* dy;
+    int* dx;
+    long* off;
+    long row_stride;
+    long pix_stride;
+    long image_stride;
+} im2col_view;
+
+// GEMM 的一个操作数：稠密矩阵，或者隐式 im2col 矩阵 (view 非空)
+typedef struct {
+    const float* data;
+    int ld;
+    const im2col_view* view;
+} operand;
+
+static inline int min_int(int a, int b) { return a < b ? a : b; }
+static inline int ceil_div(int a, int b) { return (a + b - 1) / b; }
+
+static inline __mmask16 tail_mask(int n) {
+    if (n >= 16) return 0xFFFF;
+    if (n <= 0) return 0;
+    return (__mmask16)((1u << n) - 1);
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int conv_init(conv_params* p) {
+    p->oh = (p->h + 2 * p->pad_h - p->dil_h * (p->kh - 1) - 1) / p->stride_h + 1;
+    p->ow = (p->w + 2 * p->pad_w - p->dil_w * (p->kw - 1) - 1) / p->stride_w + 1;
+    return p->oh > 0 && p->ow > 0 ? 0 : -1;
+}
+
+// 预计算每个 k 的抽头位置，k 的顺序与权重布局一致
+int view_create(im2col_view* v, const conv_params* p) {
+    int K = p->c * p->kh * p->kw;
+    v->p = p;
+    v->dy = (int*)malloc(sizeof(int) * K);
+    v->dx = (int*)malloc(sizeof(int) * K);
+    v->off = (long*)malloc(sizeof(long) * K);
+    if (!v->dy || !v->dx || !v->off) return -1;
+
+    long chan_stride;
+    if (p->layout == LAYOUT_NCHW) {
+        v->row_stride = p->w;
+        v->pix_stride = 1;
+        chan_stride = (long)p->h * p->w;
+    } else {
+        v->row_stride = (long)p->w * p->c;
+        v->pix_stride = p->c;
+        chan_stride = 1;
+    }
+    v->image_stride = (long)p->c * p->h * p->w;
+
+    for (int c = 0; c < p->c; c++) {
+        for (int y = 0; y < p->kh; y++) {
+            for (int x = 0; x < p->kw; x++) {
+                int k = p->layout == LAYOUT_NCHW ? (c * p->kh + y) * p->kw + x
+                                                 : (y * p->kw + x) * p->c + c;
+                v->dy[k] = y * p->dil_h;
+                v->dx[k] = x * p->dil_w;
+                v->off[k] = v->dy[k] * v->row_stride + v->dx[k] * v->pix_stride + c * chan_stride;
+            }
+        }
+    }
+    return 0;
+}
+
+void view_destroy(im2col_view* v) {
+    free(v->dy);
+    free(v->dx);
+    free(v->off);
+}
+
+// 补丁 q 的左上角在输入中的坐标与偏移 (可能落在填充区，偏移可以为负)
+static inline void patch_origin(const im2col_view* v, int q, long* base, int* iy, int* ix) {
+    const conv_params* p = v->p;
+    int ohw = p->oh * p->ow;
+    int n = q / ohw;
+    int r = q % ohw;
+    *iy = (r / p->ow) * p->stride_h - p->pad_h;
+    *ix = (r % p->ow) * p->stride_w - p->pad_w;
+    *base = n * v->image_stride + *iy * v->row_stride + *ix * v->pix_stride;
+}
+
+static inline float tap(const im2col_view* v, const float* in, long base, int iy, int ix, int k) {
+    int y = iy + v->dy[k];
+    int x = ix + v->dx[k];
+    if ((unsigned)y >= (unsigned)v->p->h || (unsigned)x >= (unsigned)v->p->w) return 0.0f;
+    return in[base + v->off[k]];
+}
+
+// 打包 A 的 mc x kc 块；隐式矩阵时每行是一个补丁，边收集边打包
+void pack_a(int mc, int kc, const operand* A, int i0, int k0, float* pa) {
+    for (int i = 0; i < mc; i += MR) {
+        int mr = min_int(MR, mc - i);
+        if (A->view) {
+            long base[MR];
+            int iy[MR], ix[MR];
+            for (int r = 0; r < mr; r++) patch_origin(A->view, i0 + i + r, &base[r], &iy[r], &ix[r]);
+            for (int k = 0; k < kc; k++) {
+                for (int r = 0; r < mr; r++) pa[r] = tap(A->view, A->data, base[r], iy[r], ix[r], k0 + k);
+                for (int r = mr; r < MR; r++) pa[r] = 0.0f;
+                pa += MR;
+            }
+        } else {
+            const float* a = A->data + (size_t)(i0 + i) * A->ld + k0;
+            for (int k = 0; k < kc; k++) {
+                for (int r = 0; r < mr; r++) pa[r] = a[(size_t)r * A->ld + k];
+                for (int r = mr; r < MR; r++) pa[r] = 0.0f;
+                pa += MR;
+            }
+        }
+    }
+}
+
+// NCHW 且横向步长为 1 时，同一输出行上相邻的补丁在输入里也相邻：
+// 把 nr 个补丁按输出行切成若干段，每段对每个 k 做一次掩码向量加载，越界部分由掩码补零
+static void pack_b_unit_stride(int kc, int nr, const operand* B, int k0, int q0, float* pb) {
+    const im2col_view* v = B->view;
+    int seg_c0[NR + 1], seg_iy[NR], seg_ix[NR];
+    long seg_base[NR];
+    int nseg = 0;
+    for (int c = 0; c < nr; ) {
+        patch_origin(v, q0 + c, &seg_base[nseg], &seg_iy[nseg], &seg_ix[nseg]);
+        seg_c0[nseg++] = c;
+        c += min_int(nr - c, v->p->ow - (q0 + c) % v->p->ow);
+    }
+    seg_c0[nseg] = nr;
+
+    for (int k = 0; k < kc; k++) {
+        int dy = v->dy[k0 + k], dx = v->dx[k0 + k];
+        __m512 lo = _mm512_setzero_ps();
+        __m512 hi = _mm512_setzero_ps();
+        for (int s = 0; s < nseg; s++) {
+            if ((unsigned)(seg_iy[s] + dy) >= (unsigned)v->p->h) continue;
+            int x0 = seg_ix[s] + dx;
+            int c_lo = seg_c0[s] + (x0 < 0 ? -x0 : 0);
+            int c_hi = min_int(seg_c0[s + 1], seg_c0[s] + v->p->w - x0);
+            if (c_lo >= c_hi) continue;
+            unsigned long long bits = ((1ull << c_hi) - 1) & ~((1ull << c_lo) - 1);
+            const float* src = B->data + seg_base[s] + v->off[k0 + k] - seg_c0[s];
+            lo = _mm512_mask_loadu_ps(lo, (__mmask16)bits, src);
+            hi = _mm512_mask_loadu_ps(hi, (__mmask16)(bits >> 16), src + 16);
+        }
+        _mm512_store_ps(pb, lo);
+        _mm512_store_ps(pb + 16, hi);
+        pb += NR;
+    }
+}
+
+// 打包 B 的 kc x nc 块；隐式矩阵时每列是一个补丁
+void pack_b(int kc, int nc, const operand* B, int k0, int j0, float* pb) {
+    for (int j = 0; j < nc; j += NR) {
+        int nr = min_int(NR, nc - j);
+        if (B->view && B->view->pix_stride == 1 && B->view->p->stride_w == 1) {
+            pack_b_unit_stride(kc, nr, B, k0, j0 + j, pb);
+            pb += (size_t)kc * NR;
+        } else if (B->view) {
+            long base[NR];
+            int iy[NR], ix[NR];
+            for (int c = 0; c < nr; c++) patch_origin(B->view, j0 + j + c, &base[c], &iy[c], &ix[c]);
+            for (int k = 0; k < kc; k++) {
+                for (int c = 0; c < nr; c++) pb[c] = tap(B->view, B->data, base[c], iy[c], ix[c], k0 + k);
+                for (int c = nr; c < NR; c++) pb[c] = 0.0f;
+                pb += NR;
+            }
+        } else {
+            __mmask16 m0 = tail_mask(nr);
+            __mmask16 m1 = tail_mask(nr - 16);
+            for (int k = 0; k < kc; k++) {
+                const float* b = B->data + (size_t)(k0 + k) * B->ld + j0 + j;
+                _mm512_store_ps(pb, _mm512_maskz_loadu_ps(m0, b));
+                _mm512_store_ps(pb + 16, _mm512_maskz_loadu_ps(m1, b + 16));
+                pb += NR;
+            }
+        }
+    }
+}
+
+void micro_kernel(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr) {
+    __m512 c0[MR], c1[MR];
+    for (int r = 0; r < MR; r++) {
+        c0[r] = _mm512_setzero_ps();
+        c1[r] = _mm512_setzero_ps();
+    }
+
+    for (int k = 0; k < kc; k++) {
+        __m512 b0 = _mm512_load_ps(pb);
+        __m512 b1 = _mm512_load_ps(pb + 16);
+        for (int r = 0; r < MR; r++) {
+            __m512 a = _mm512_set1_ps(pa[r]);
+            c0[r] = _mm512_fmadd_ps(a, b0, c0[r]);
+            c1[r] = _mm512_fmadd_ps(a, b1, c1[r]);
+        }
+        pa += MR;
+        pb += NR;
+    }
+
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int r = 0; r < mr; r++) {
+        float* c = C + (size_t)r * ldc;
+        _mm512_mask_storeu_ps(c, m0, _mm512_add_ps(c0[r], _mm512_maskz_loadu_ps(m0, c)));
+        _mm512_mask_storeu_ps(c + 16, m1, _mm512_add_ps(c1[r], _mm512_maskz_loadu_ps(m1, c + 16)));
+    }
+}
+
+// 单线程分块 GEMM：C[m x n] += A[i0.., :] * B[:, j0..]
+void gemm_serial(int m, int n, int k, const operand* A, int i0, const operand* B, int j0,
+                 float* C, int ldc, float* pa, float* pb) {
+    for (int jc = 0; jc < n; jc += NC_BLOCK) {
+        int nc = min_int(NC_BLOCK, n - jc);
+        for (int pc = 0; pc < k; pc += KC_BLOCK) {
+            int kc = min_int(KC_BLOCK, k - pc);
+            pack_b(kc, nc, B, pc, j0 + jc, pb);
+            for (int ic = 0; ic < m; ic += MC_BLOCK) {
+                int mc = min_int(MC_BLOCK, m - ic);
+                pack_a(mc, kc, A, i0 + ic, pc, pa);
+                for (int jr = 0; jr < nc; jr += NR) {
+                    for (int ir = 0; ir < mc; ir += MR) {
+                        micro_kernel(kc, pa + ir * kc, pb + jr * kc,
+                                     C + (size_t)(ic + ir) * ldc + jc + jr, ldc,
+                                     min_int(MR, mc - ir), min_int(NR, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void choose_grid(int m, int n, int k, int nthreads, int* tm_out, int* tn_out) {
+    double best = -1.0;
+    for (int tm = 1; tm <= nthreads; tm++) {
+        if (nthreads % tm) continue;
+        int tn = nthreads / tm;
+        int mt = ceil_div(ceil_div(m, MR), tm) * MR;
+        int nt = ceil_div(ceil_div(n, NR), tn) * NR;
+        double cost = 2.0 * mt * nt * k / COST_FLOP_RATE;
+        cost += ((double)mt * k + (double)k * nt) * sizeof(float) / COST_MOVE_RATE;
+        if (best < 0.0 || cost < best) {
+            best = cost;
+            *tm_out = tm;
+            *tn_out = tn;
+        }
+    }
+}
+
+// 并行计算 C = A * B，A / B 可以是隐式 im2col 矩阵
+int gemm_run(int m, int n, int k, const operand* A, const operand* B, float* C, int ldc) {
+    int nthreads = omp_get_max_threads();
+    int tm = nthreads, tn = 1;
+    choose_grid(m, n, k, nthreads, &tm, &tn);
+
+    int rows_per = ceil_div(ceil_div(m, MR), tm) * MR;
+    int cols_per = ceil_div(ceil_div(n, NR), tn) * NR;
+    int failed = 0;
+
+    #pragma omp parallel num_threads(tm * tn)
+    {
+        int tid = omp_get_thread_num();
+        int i0 = min_int(m, (tid % tm) * rows_per), i1 = min_int(m, i0 + rows_per);
+        int j0 = min_int(n, (tid / tm) * cols_per), j1 = min_int(n, j0 + cols_per);
+
+        for (int i = i0; i < i1; i++) {
+            memset(C + (size_t)i * ldc + j0, 0, sizeof(float) * (j1 - j0));
+        }
+
+        float* pa = (float*)aligned_alloc(64, sizeof(float) * MC_BLOCK * KC_BLOCK);
+        float* pb = (float*)aligned_alloc(64, sizeof(float) * KC_BLOCK * NC_BLOCK);
+        if (!pa || !pb) {
+            #pragma omp atomic write
+            failed = 1;
+        } else if (i1 > i0 && j1 > j0) {
+            gemm_serial(i1 - i0, j1 - j0, k, A, i0, B, j0, C + (size_t)i0 * ldc + j0, ldc, pa, pb);
+        }
+        free(pa);
+        free(pb);
+    }
+    return failed ? -1 : 0;
+}
+
+// 隐式 GEMM 卷积：打包时直接从输入收集补丁
+// NCHW：逐张图像计算 W[OC x CKK] * 补丁[CKK x OHW]
+// NHWC：整批计算 补丁[N*OHW x KKC] * W[KKC x OC]
+int conv2d(const conv_params* p, const float* input, const float* weight, float* output) {
+    im2col_view view;
+    int K = p->c * p->kh * p->kw;
+    int ohw = p->oh * p->ow;
+    int ret = view_create(&view, p);
+
+    if (!ret && p->layout == LAYOUT_NCHW) {
+        operand A = { weight, K, NULL };
+        for (int n = 0; n < p->n && !ret; n++) {
+            operand B = { input + (size_t)n * view.image_stride, 0, &view };
+            ret = gemm_run(p->oc, ohw, K, &A, &B, output + (size_t)n * p->oc * ohw, ohw);
+        }
+    } else if (!ret) {
+        operand A = { input, 0, &view };
+        operand B = { weight, p->oc, NULL };
+        ret = gemm_run(p->n * ohw, p->oc, K, &A, &B, output, p->oc);
+    }
+    view_destroy(&view);
+    return ret;
+}
+
+// 对照组：显式 im2col 展开后再做稠密 GEMM，buf 由调用者提供
+// NCHW 每张图像展开成 CKK x OHW 并复用同一块缓冲区，NHWC 整批展开成 N*OHW x KKC
+int conv2d_im2col(const conv_params* p, const float* input, const float* weight, float* output,
+                  float* buf, double* t_im2col) {
+    im2col_view view;
+    int K = p->c * p->kh * p->kw;
+    int ohw = p->oh * p->ow;
+    int ret = view_create(&view, p);
+    *t_im2col = 0.0;
+
+    if (!ret && p->layout == LAYOUT_NCHW) {
+        operand A = { weight, K, NULL };
+        operand B = { buf, ohw, NULL };
+        for (int n = 0; n < p->n && !ret; n++) {
+            const float* in = input + (size_t)n * view.image_stride;
+            double t0 = now_sec();
+            #pragma omp parallel for schedule(static)
+            for (int q = 0; q < ohw; q++) {
+                long base;
+                int iy, ix;
+                patch_origin(&view, q, &base, &iy, &ix);
+                for (int k = 0; k < K; k++) buf[(size_t)k * ohw + q] = tap(&view, in, base, iy, ix, k);
+            }
+            *t_im2col += now_sec() - t0;
+            ret = gemm_run(p->oc, ohw, K, &A, &B, output + (size_t)n * p->oc * ohw, ohw);
+        }
+    } else if (!ret) {
+        int rows = p->n * ohw;
+        double t0 = now_sec();
+        #pragma omp parallel for schedule(static)
+        for (int q = 0; q < rows; q++) {
+            long base;
+            int iy, ix;
+            patch_origin(&view, q, &base, &iy, &ix);
+            for (int k = 0; k < K; k++) buf[(size_t)q * K + k] = tap(&view, input, base, iy, ix, k);
+        }
+        *t_im2col = now_sec() - t0;
+        operand A = { buf, K, NULL };
+        operand B = { weight, p->oc, NULL };
+        ret = gemm_run(rows, p->oc, K, &A, &B, output, p->oc);
+    }
+    view_destroy(&view);
+    return ret;
+}
+
+size_t im2col_buffer_size(const conv_params* p) {
+    size_t K = (size_t)p->c * p->kh * p->kw;
+    size_t ohw = (size_t)p->oh * p->ow;
+    return p->layout == LAYOUT_NCHW ? K * ohw : K * ohw * p->n;
+}
+
+void init_matrix(float* M, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        M[i] = (float)rand() / RAND_MAX - 0.5f;
+    }
+}
+
+// 抽样若干输出位置，与直接卷积的双精度结果比较
+double check_result(const conv_params* p, const float* in, const float* wt, const float* out) {
+    double max_err = 0.0;
+    for (int s = 0; s < 64; s++) {
+        int n = rand() % p->n, o = rand() % p->oc, y = rand() % p->oh, x = rand() % p->ow;
+        double ref = 0.0, mag = 0.0;
+        for (int c = 0; c < p->c; c++) {
+            for (int ky = 0; ky < p->kh; ky++) {
+                for (int kx = 0; kx < p->kw; kx++) {
+                    int iy = y * p->stride_h - p->pad_h + ky * p->dil_h;
+                    int ix = x * p->stride_w - p->pad_w + kx * p->dil_w;
+                    if (iy < 0 || iy >= p->h || ix < 0 || ix >= p->w) continue;
+                    double a, b;
+                    if (p->layout == LAYOUT_NCHW) {
+                        a = in[(((size_t)n * p->c + c) * p->h + iy) * p->w + ix];
+                        b = wt[(((size_t)o * p->c + c) * p->kh + ky) * p->kw + kx];
+                    } else {
+                        a = in[(((size_t)n * p->h + iy) * p->w + ix) * p->c + c];
+                        b = wt[(((size_t)ky * p->kw + kx) * p->c + c) * p->oc + o];
+                    }
+                    ref += a * b;
+                    mag += fabs(a * b);
+                }
+            }
+        }
+        size_t idx = p->layout == LAYOUT_NCHW ? (((size_t)n * p->oc + o) * p->oh + y) * p->ow + x
+                                              : (((size_t)n * p->oh + y) * p->ow + x) * p->oc + o;
+        double err = fabs(out[idx] - ref) / (mag + 1e-30);
+        if (err > max_err) max_err = err;
+    }
+    return max_err;
+}
+
+void bench_conv(conv_params p) {
+    if (conv_init(&p)) {
+        fprintf(stderr, "卷积参数无效\n");
+        return;
+    }
+    size_t in_size = (size_t)p.n * p.c * p.h * p.w;
+    size_t wt_size = (size_t)p.oc * p.c * p.kh * p.kw;
+    size_t out_size = (size_t)p.n * p.oc * p.oh * p.ow;
+    size_t buf_size = im2col_buffer_size(&p);
+
+    float* in = (float*)aligned_alloc(64, sizeof(float) * (in_size + 16));
+    float* wt = (float*)aligned_alloc(64, sizeof(float) * (wt_size + 16));
+    float* out = (float*)aligned_alloc(64, sizeof(float) * (out_size + 16));
+    float* buf = (float*)aligned_alloc(64, sizeof(float) * (buf_size + 16));
+    if (!in || !wt || !out || !buf) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    init_matrix(in, in_size);
+    init_matrix(wt, wt_size);
+
+    double flops = 2.0 * out_size * p.c * p.kh * p.kw;
+    size_t pack_bytes = sizeof(float) * (MC_BLOCK * KC_BLOCK + KC_BLOCK * NC_BLOCK) * omp_get_max_threads();
+
+    printf("%s N=%d C=%d H=%d W=%d -> OC=%d OH=%d OW=%d  核 %dx%d  步长 %d  填充 %d  空洞 %d\n",
+           p.layout == LAYOUT_NCHW ? "NCHW" : "NHWC", p.n, p.c, p.h, p.w, p.oc, p.oh, p.ow,
+           p.kh, p.kw, p.stride_h, p.pad_h, p.dil_h);
+
+    double t_im2col;
+    conv2d_im2col(&p, in, wt, out, buf, &t_im2col);
+    double t0 = now_sec();
+    if (conv2d_im2col(&p, in, wt, out, buf, &t_im2col)) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    double t_explicit = now_sec() - t0;
+    printf("  显式 im2col+GEMM: %.4f 秒 (其中 im2col %.4f 秒)  %.2f GFLOPS  额外内存: %.2f MB (输入的 %.1fx)  误差: %.2e\n",
+           t_explicit, t_im2col, flops / t_explicit / 1e9, sizeof(float) * buf_size / 1048576.0,
+           (double)buf_size / in_size, check_result(&p, in, wt, out));
+
+    conv2d(&p, in, wt, out);
+    t0 = now_sec();
+    if (conv2d(&p, in, wt, out)) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    double t_implicit = now_sec() - t0;
+    printf("  隐式 GEMM:        %.4f 秒                      %.2f GFLOPS  额外内存: %.2f MB (仅打包缓冲区)  误差: %.2e\n",
+           t_implicit, flops / t_implicit / 1e9, pack_bytes / 1048576.0, check_result(&p, in, wt, out));
+
+    free(in);
+    free(wt);
+    free(out);
+    free(buf);
+}
+
+int main() {
+    srand(time(NULL));
+    printf("线程数: %d\n", omp_get_max_threads());
+
+    // layout, n, c, h, w, oc, kh, kw, stride, pad, dilation
+    static const conv_params convs[] = {
+        { LAYOUT_NCHW, 8, 64, 56, 56, 64, 3, 3, 1, 1, 1, 1, 1, 1, 0, 0 },
+        { LAYOUT_NHWC, 8, 64, 56, 56, 64, 3, 3, 1, 1, 1, 1, 1, 1, 0, 0 },
+        { LAYOUT_NCHW, 8, 128, 28, 28, 256, 3, 3, 2, 2, 1, 1, 1, 1, 0, 0 },
+        { LAYOUT_NHWC, 8, 128, 28, 28, 256, 3, 3, 2, 2, 1, 1, 1, 1, 0, 0 },
+        { LAYOUT_NCHW, 4, 256, 28, 28, 256, 3, 3, 1, 1, 2, 2, 2, 2, 0, 0 },
+        { LAYOUT_NHWC, 4, 256, 28, 28, 256, 3, 3, 1, 1, 2, 2, 2, 2, 0, 0 },
+    };
+    for (size_t i = 0; i < sizeof(convs) / sizeof(convs[0]); i++) {
+        bench_conv(convs[i]);
+    }
+    return 0;
+}
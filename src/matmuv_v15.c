@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include <immintrin.h>
+
+// 一次同时处理的 A 行数 (GEMV)，每行两个累加器掩盖 FMA 延迟
+#define GEMV_ROWS 4
+// 小 N 矩阵乘一次处理的 A 行数，累加器个数为 SKINNY_ROWS * n <= 16
+#define SKINNY_ROWS 2
+#define SKINNY_MAX_N 8
+// 非临时预取距离 (float 个数)：A 只读一遍，不必污染缓存
+#define NTA_DISTANCE 512
+// K 方向分块：x / B 的一段常驻 L2，A 的每一行只在这一段里流过，长 K 时不必反复从内存读 x / B
+#define SKINNY_KC 4096
+// 每线程至少分到的行组数，少于该值改为沿 K 切分
+#define MIN_ROW_GROUPS 4
+// 带宽探测缓冲区大小
+#define PROBE_BYTES (512ul << 20)
+
+static inline int min_int(int a, int b) { return a < b ? a : b; }
+static inline int ceil_div(int a, int b) { return (a + b - 1) / b; }
+
+static inline __mmask16 tail_mask(int n) {
+    if (n >= 16) return 0xFFFF;
+    if (n <= 0) return 0;
+    return (__mmask16)((1u << n) - 1);
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 测量全部线程并行只读的峰值带宽 (GB/s)
+double probe_bandwidth(void) {
+    size_t count = PROBE_BYTES / sizeof(float);
+    float* buf = (float*)aligned_alloc(64, PROBE_BYTES);
+    if (!buf) return 0.0;
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < count; i++) buf[i] = 1.0f;
+
+    double best = 0.0;
+    float sink = 0.0f;
+    for (int rep = 0; rep < 3; rep++) {
+        double t0 = now_sec();
+        #pragma omp parallel reduction(+:sink)
+        {
+            __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+            __m512 s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps();
+            #pragma omp for schedule(static)
+            for (size_t i = 0; i < count; i += 64) {
+                s0 = _mm512_add_ps(s0, _mm512_load_ps(buf + i));
+                s1 = _mm512_add_ps(s1, _mm512_load_ps(buf + i + 16));
+                s2 = _mm512_add_ps(s2, _mm512_load_ps(buf + i + 32));
+                s3 = _mm512_add_ps(s3, _mm512_load_ps(buf + i + 48));
+            }
+            sink += _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(s0, s1), _mm512_add_ps(s2, s3)));
+        }
+        double gbs = PROBE_BYTES / (now_sec() - t0) / 1e9;
+        if (gbs > best) best = gbs;
+    }
+    if (sink != (float)count * 3) buf[0] = sink;
+    free(buf);
+    return best;
+}
+
+// y[i0..i1) (+)= A[i0..i1, k0..k1) * x[k0..k1) (y 的跨度为 ldy)，每次 GEMV_ROWS 行，A 按整条 zmm 顺序流过
+static void gemv_rows(int i0, int i1, int k0, int k1, const float* A, int lda, const float* x,
+                      float* y, int ldy, int accumulate) {
+    int i = i0;
+    for (; i + GEMV_ROWS <= i1; i += GEMV_ROWS) {
+        const float* a[GEMV_ROWS];
+        __m512 acc0[GEMV_ROWS], acc1[GEMV_ROWS];
+        for (int r = 0; r < GEMV_ROWS; r++) {
+            a[r] = A + (size_t)(i + r) * lda;
+            acc0[r] = _mm512_setzero_ps();
+            acc1[r] = _mm512_setzero_ps();
+        }
+        int k = k0;
+        for (; k + 32 <= k1; k += 32) {
+            __m512 x0 = _mm512_loadu_ps(x + k);
+            __m512 x1 = _mm512_loadu_ps(x + k + 16);
+            for (int r = 0; r < GEMV_ROWS; r++) {
+                _mm_prefetch((const char*)(a[r] + k + NTA_DISTANCE), _MM_HINT_NTA);
+                _mm_prefetch((const char*)(a[r] + k + NTA_DISTANCE + 16), _MM_HINT_NTA);
+                acc0[r] = _mm512_fmadd_ps(_mm512_loadu_ps(a[r] + k), x0, acc0[r]);
+                acc1[r] = _mm512_fmadd_ps(_mm512_loadu_ps(a[r] + k + 16), x1, acc1[r]);
+            }
+        }
+        for (; k < k1; k += 16) {
+            __mmask16 m = tail_mask(k1 - k);
+            __m512 xv = _mm512_maskz_loadu_ps(m, x + k);
+            for (int r = 0; r < GEMV_ROWS; r++) {
+                acc0[r] = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a[r] + k), xv, acc0[r]);
+            }
+        }
+        for (int r = 0; r < GEMV_ROWS; r++) {
+            float v = _mm512_reduce_add_ps(_mm512_add_ps(acc0[r], acc1[r]));
+            y[(size_t)(i + r) * ldy] = accumulate ? y[(size_t)(i + r) * ldy] + v : v;
+        }
+    }
+    for (; i < i1; i++) {
+        const float* a = A + (size_t)i * lda;
+        __m512 acc = _mm512_setzero_ps();
+        for (int k = k0; k < k1; k += 16) {
+            __mmask16 m = tail_mask(k1 - k);
+            acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + k), _mm512_maskz_loadu_ps(m, x + k), acc);
+        }
+        float v = _mm512_reduce_add_ps(acc);
+        y[(size_t)i * ldy] = accumulate ? y[(size_t)i * ldy] + v : v;
+    }
+}
+
+// C[i0..i1, 0..NB) (+)= A * B，bt 为 B 的转置 (NB x ldbt)，NB 为编译期常数以便累加器全部放进寄存器
+static inline __attribute__((always_inline))
+void skinny_rows(const int NB, int i0, int i1, int k0, int k1, const float* A, int lda,
+                 const float* bt, int ldbt, float* C, int ldc, int accumulate) {
+    int i = i0;
+    for (; i + SKINNY_ROWS <= i1; i += SKINNY_ROWS) {
+        const float* a0 = A + (size_t)i * lda;
+        const float* a1 = a0 + lda;
+        __m512 acc0[SKINNY_MAX_N], acc1[SKINNY_MAX_N];
+        for (int j = 0; j < NB; j++) {
+            acc0[j] = _mm512_setzero_ps();
+            acc1[j] = _mm512_setzero_ps();
+        }
+        for (int k = k0; k < k1; k += 16) {
+            __mmask16 m = tail_mask(k1 - k);
+            _mm_prefetch((const char*)(a0 + k + NTA_DISTANCE), _MM_HINT_NTA);
+            _mm_prefetch((const char*)(a1 + k + NTA_DISTANCE), _MM_HINT_NTA);
+            __m512 va0 = _mm512_maskz_loadu_ps(m, a0 + k);
+            __m512 va1 = _mm512_maskz_loadu_ps(m, a1 + k);
+            for (int j = 0; j < NB; j++) {
+                __m512 b = _mm512_load_ps(bt + (size_t)j * ldbt + k);
+                acc0[j] = _mm512_fmadd_ps(va0, b, acc0[j]);
+                acc1[j] = _mm512_fmadd_ps(va1, b, acc1[j]);
+            }
+        }
+        for (int j = 0; j < NB; j++) {
+            float* c0 = C + (size_t)i * ldc + j;
+            float* c1 = c0 + ldc;
+            *c0 = (accumulate ? *c0 : 0.0f) + _mm512_reduce_add_ps(acc0[j]);
+            *c1 = (accumulate ? *c1 : 0.0f) + _mm512_reduce_add_ps(acc1[j]);
+        }
+    }
+    for (; i < i1; i++) {
+        const float* a0 = A + (size_t)i * lda;
+        __m512 acc0[SKINNY_MAX_N];
+        for (int j = 0; j < NB; j++) acc0[j] = _mm512_setzero_ps();
+        for (int k = k0; k < k1; k += 16) {
+            __m512 va0 = _mm512_maskz_loadu_ps(tail_mask(k1 - k), a0 + k);
+            for (int j = 0; j < NB; j++) {
+                acc0[j] = _mm512_fmadd_ps(va0, _mm512_load_ps(bt + (size_t)j * ldbt + k), acc0[j]);
+            }
+        }
+        for (int j = 0; j < NB; j++) {
+            float* c0 = C + (size_t)i * ldc + j;
+            *c0 = (accumulate ? *c0 : 0.0f) + _mm512_reduce_add_ps(acc0[j]);
+        }
+    }
+}
+
+static void skinny_dispatch(int n, int i0, int i1, int k0, int k1, const float* A, int lda,
+                            const float* bt, int ldbt, float* C, int ldc, int accumulate) {
+    switch (n) {
+        case 2: skinny_rows(2, i0, i1, k0, k1, A, lda, bt, ldbt, C, ldc, accumulate); break;
+        case 3: skinny_rows(3, i0, i1, k0, k1, A, lda, bt, ldbt, C, ldc, accumulate); break;
+        case 4: skinny_rows(4, i0, i1, k0, k1, A, lda, bt, ldbt, C, ldc, accumulate); break;
+        case 5: skinny_rows(5, i0, i1, k0, k1, A, lda, bt, ldbt, C, ldc, accumulate); break;
+        case 6: skinny_rows(6, i0, i1, k0, k1, A, lda, bt, ldbt, C, ldc, accumulate); break;
+        case 7: skinny_rows(7, i0, i1, k0, k1, A, lda, bt, ldbt, C, ldc, accumulate); break;
+        default: skinny_rows(8, i0, i1, k0, k1, A, lda, bt, ldbt, C, ldc, accumulate); break;
+    }
+}
+
+// C[m x n] = A[m x k] * B[k x n]，n <= 8；n == 1 时就是 GEMV
+// 行数足够时按行切给各线程；行数太少时沿 K 切分，各线程写部分和再归约
+int gemm_skinny(int m, int n, int k, const float* A, int lda, const float* B, int ldb, float* C, int ldc) {
+    if (n < 1 || n > SKINNY_MAX_N) return -1;
+
+    int nthreads = omp_get_max_threads();
+    int group = n == 1 ? GEMV_ROWS : SKINNY_ROWS;
+    int tk = 1;
+    if (ceil_div(m, group) < nthreads * MIN_ROW_GROUPS) {
+        tk = min_int(nthreads, ceil_div(k, 1024));
+    }
+
+    // B 转置成 n 行，每行补齐到 16 的倍数，供内核按 zmm 读取；GEMV 的 x 连续时直接使用
+    int ldbt = ceil_div(k, 16) * 16;
+    float* bt = NULL;
+    if (n > 1 || ldb != 1) {
+        bt = (float*)aligned_alloc(64, sizeof(float) * (size_t)n * ldbt);
+        if (!bt) return -1;
+        #pragma omp parallel for schedule(static)
+        for (int p = 0; p < k; p++) {
+            for (int j = 0; j < n; j++) bt[(size_t)j * ldbt + p] = B[(size_t)p * ldb + j];
+        }
+        for (int j = 0; j < n; j++) {
+            for (int p = k; p < ldbt; p++) bt[(size_t)j * ldbt + p] = 0.0f;
+        }
+    }
+    float* partial = NULL;
+    if (tk > 1) {
+        partial = (float*)aligned_alloc(64, sizeof(float) * (size_t)tk * m * n + 64);
+        if (!partial) {
+            free(bt);
+            return -1;
+        }
+    }
+
+    int k_per = ceil_div(ceil_div(k, 16), tk) * 16;
+
+    // 线程轮流分到 tk 个 K 分组，除不尽时前 nthreads % tk 组多一个线程，组内再按行切分
+    #pragma omp parallel num_threads(nthreads)
+    {
+        int tid = omp_get_thread_num();
+        int g = tid % tk;
+        int tm = nthreads / tk + (g < nthreads % tk);
+        int rows_per = ceil_div(ceil_div(m, group), tm) * group;
+        int i0 = min_int(m, (tid / tk) * rows_per), i1 = min_int(m, i0 + rows_per);
+        int k0 = min_int(k, g * k_per), k1 = min_int(k, k0 + k_per);
+        float* dst = tk > 1 ? partial + (size_t)g * m * n : C;
+        int ldd = tk > 1 ? n : ldc;
+
+        for (int kb = k0; kb < k1; kb += SKINNY_KC) {
+            int ke = min_int(kb + SKINNY_KC, k1);
+            if (n == 1) {
+                gemv_rows(i0, i1, kb, ke, A, lda, bt ? bt : B, dst, ldd, kb > k0);
+            } else {
+                skinny_dispatch(n, i0, i1, kb, ke, A, lda, bt, ldbt, dst, ldd, kb > k0);
+            }
+        }
+
+        if (tk > 1) {
+            #pragma omp barrier
+            #pragma omp for schedule(static)
+            for (int i = 0; i < m; i++) {
+                for (int j = 0; j < n; j++) {
+                    float s = 0.0f;
+                    for (int p = 0; p < tk; p++) s += partial[((size_t)p * m + i) * n + j];
+                    C[(size_t)i * ldc + j] = s;
+                }
+            }
+        }
+    }
+
+    free(partial);
+    free(bt);
+    return 0;
+}
+
+// y = A * x
+int sgemv(int m, int k, const float* A, int lda, const float* x, float* y) {
+    return gemm_skinny(m, 1, k, A, lda, x, 1, y, 1);
+}
+
+void init_matrix(float* M, size_t count) {
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < count; i++) {
+        M[i] = (float)((i * 2654435761u) % 1000) / 1000.0f;
+    }
+}
+
+double check_result(int m, int n, int k, const float* A, const float* B, const float* C) {
+    double max_err = 0.0;
+    for (int s = 0; s < 64; s++) {
+        int i = rand() % m;
+        int j = rand() % n;
+        double ref = 0.0;
+        for (int p = 0; p < k; p++) ref += (double)A[(size_t)i * k + p] * B[(size_t)p * n + j];
+        double err = fabs(C[(size_t)i * n + j] - ref) / (fabs(ref) + 1e-30);
+        if (err > max_err) max_err = err;
+    }
+    return max_err;
+}
+
+void bench_shape(int m, int n, int k, double peak) {
+    float* A = (float*)aligned_alloc(64, sizeof(float) * ((size_t)m * k + 16));
+    float* B = (float*)aligned_alloc(64, sizeof(float) * ((size_t)k * n + 16));
+    float* C = (float*)aligned_alloc(64, sizeof(float) * ((size_t)m * n + 16));
+    if (!A || !B || !C) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    init_matrix(A, (size_t)m * k);
+    init_matrix(B, (size_t)k * n);
+
+    const int reps = 5;
+    gemm_skinny(m, n, k, A, k, B, n, C, n);
+    double t0 = now_sec();
+    for (int r = 0; r < reps; r++) gemm_skinny(m, n, k, A, k, B, n, C, n);
+    double t = (now_sec() - t0) / reps;
+
+    double bytes = sizeof(float) * ((double)m * k + (double)k * n + (double)m * n);
+    double gbs = bytes / t / 1e9;
+    printf("M=%d N=%d K=%d  时间: %.3f 毫秒  带宽: %.2f GB/s (峰值的 %.1f%%)  性能: %.2f GFLOPS  最大相对误差: %.2e\n",
+           m, n, k, t * 1e3, gbs, 100.0 * gbs / peak, 2.0 * m * n * k / t / 1e9,
+           check_result(m, n, k, A, B, C));
+
+    free(A);
+    free(B);
+    free(C);
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    double peak = probe_bandwidth();
+    printf("线程数: %d  探测到的峰值读带宽: %.2f GB/s\n", omp_get_max_threads(), peak);
+
+    if (argc == 4) {
+        bench_shape(atoi(argv[1]), atoi(argv[2]), atoi(argv[3]), peak);
+        return 0;
+    }
+
+    static const int ns[] = { 1, 2, 4, 8 };
+    for (size_t i = 0; i < sizeof(ns) / sizeof(ns[0]); i++) {
+        bench_shape(8192, ns[i], 8192, peak);
+    }
+    // 行数很少、K 很长：沿 K 切分
+    bench_shape(16, 1, 1 << 22, peak);
+    bench_shape(16, 4, 1 << 22, peak);
+    return 0;
+}
@@ -0,0 +1,470 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include <immintrin.h>
+
+// 复数矩阵按 (实部, 虚部) 交错存放，ld 以复数个数计
+// 复数微内核：CMR 行 x CNR 列复数，每行 2 个 zmm，实部/虚部两组累加器共 24 个 zmm
+#define CMR 6
+#define CNR 16
+// K 方向分块与实数版相同 (v9 的 L2 块 256)；复数 B 微面板连同实虚交换副本共 64KB，常驻 L2
+// 实测 KC 取 128 让 C 的读改写过于频繁，反而更慢
+#define CMC_BLOCK 96
+#define CKC_BLOCK 256
+#define CNC_BLOCK 1024
+// 实数微内核与分块 (3M 算法和四次实数 GEMM 对照组使用)
+#define MR 8
+#define NR 32
+#define MC_BLOCK 128
+#define KC_BLOCK 256
+#define NC_BLOCK 2048
+// 三个维度都不小于该值时自动改用 3M 算法
+#define CGEMM_3M_MIN 2048
+
+typedef enum { CGEMM_AUTO, CGEMM_NATIVE, CGEMM_3M } cgemm_algo;
+
+static inline int min_int(int a, int b) { return a < b ? a : b; }
+static inline int ceil_div(int a, int b) { return (a + b - 1) / b; }
+
+static inline __mmask16 tail_mask(int n) {
+    if (n >= 16) return 0xFFFF;
+    if (n <= 0) return 0;
+    return (__mmask16)((1u << n) - 1);
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ---------------- 实数 GEMM ----------------
+
+void pack_a(int mc, int kc, const float* A, int lda, float* pa) {
+    for (int i = 0; i < mc; i += MR) {
+        int mr = min_int(MR, mc - i);
+        for (int k = 0; k < kc; k++) {
+            for (int r = 0; r < mr; r++) pa[r] = A[(size_t)(i + r) * lda + k];
+            for (int r = mr; r < MR; r++) pa[r] = 0.0f;
+            pa += MR;
+        }
+    }
+}
+
+// 打包 B 的第 j 个 NR 列微面板 (kc 行)
+void pack_b_panel(int kc, int nr, const float* B, int ldb, float* pb) {
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int k = 0; k < kc; k++) {
+        const float* b = B + (size_t)k * ldb;
+        _mm512_store_ps(pb, _mm512_maskz_loadu_ps(m0, b));
+        _mm512_store_ps(pb + 16, _mm512_maskz_loadu_ps(m1, b + 16));
+        pb += NR;
+    }
+}
+
+void micro_kernel(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr) {
+    __m512 c0[MR], c1[MR];
+    for (int r = 0; r < MR; r++) {
+        c0[r] = _mm512_setzero_ps();
+        c1[r] = _mm512_setzero_ps();
+    }
+
+    for (int k = 0; k < kc; k++) {
+        __m512 b0 = _mm512_load_ps(pb);
+        __m512 b1 = _mm512_load_ps(pb + 16);
+        for (int r = 0; r < MR; r++) {
+            __m512 a = _mm512_set1_ps(pa[r]);
+            c0[r] = _mm512_fmadd_ps(a, b0, c0[r]);
+            c1[r] = _mm512_fmadd_ps(a, b1, c1[r]);
+        }
+        pa += MR;
+        pb += NR;
+    }
+
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int r = 0; r < mr; r++) {
+        float* c = C + (size_t)r * ldc;
+        _mm512_mask_storeu_ps(c, m0, _mm512_add_ps(c0[r], _mm512_maskz_loadu_ps(m0, c)));
+        _mm512_mask_storeu_ps(c + 16, m1, _mm512_add_ps(c1[r], _mm512_maskz_loadu_ps(m1, c + 16)));
+    }
+}
+
+// C = A * B (实数)：与 v9 一样按 L2 行块并行，B 面板由全体线程共同打包一次后共享
+int sgemm(int m, int n, int k, const float* A, int lda, const float* B, int ldb, float* C, int ldc) {
+    float* pb = (float*)aligned_alloc(64, sizeof(float) * KC_BLOCK * NC_BLOCK);
+    if (!pb) return -1;
+    int failed = 0;
+
+    #pragma omp parallel
+    {
+        float* pa = (float*)aligned_alloc(64, sizeof(float) * MC_BLOCK * KC_BLOCK);
+        if (!pa) {
+            #pragma omp atomic write
+            failed = 1;
+        }
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < m; i++) memset(C + (size_t)i * ldc, 0, sizeof(float) * n);
+
+        for (int jc = 0; jc < n; jc += NC_BLOCK) {
+            int nc = min_int(NC_BLOCK, n - jc);
+            for (int pc = 0; pc < k; pc += KC_BLOCK) {
+                int kc = min_int(KC_BLOCK, k - pc);
+                #pragma omp for schedule(static)
+                for (int jr = 0; jr < nc; jr += NR) {
+                    pack_b_panel(kc, min_int(NR, nc - jr), B + (size_t)pc * ldb + jc + jr, ldb, pb + jr * kc);
+                }
+                #pragma omp for schedule(dynamic)
+                for (int ic = 0; ic < m; ic += MC_BLOCK) {
+                    if (!pa) continue;
+                    int mc = min_int(MC_BLOCK, m - ic);
+                    pack_a(mc, kc, A + (size_t)ic * lda + pc, lda, pa);
+                    for (int jr = 0; jr < nc; jr += NR) {
+                        for (int ir = 0; ir < mc; ir += MR) {
+                            micro_kernel(kc, pa + ir * kc, pb + jr * kc,
+                                         C + (size_t)(ic + ir) * ldc + jc + jr, ldc,
+                                         min_int(MR, mc - ir), min_int(NR, nc - jr));
+                        }
+                    }
+                }
+            }
+        }
+        free(pa);
+    }
+    free(pb);
+    return failed ? -1 : 0;
+}
+
+// ---------------- 复数 GEMM ----------------
+
+// 打包 A：每个 k 存 CMR 个复数 (ar, ai)，不足 CMR 行补零
+void cpack_a(int mc, int kc, const float* A, int lda, float* pa) {
+    for (int i = 0; i < mc; i += CMR) {
+        int mr = min_int(CMR, mc - i);
+        for (int k = 0; k < kc; k++) {
+            for (int r = 0; r < mr; r++) {
+                pa[2 * r] = A[((size_t)(i + r) * lda + k) * 2];
+                pa[2 * r + 1] = A[((size_t)(i + r) * lda + k) * 2 + 1];
+            }
+            for (int r = mr; r < CMR; r++) {
+                pa[2 * r] = 0.0f;
+                pa[2 * r + 1] = 0.0f;
+            }
+            pa += 2 * CMR;
+        }
+    }
+}
+
+// 打包 B 的一个 CNR 列复数微面板：每个 k 先存 (br, bi) 原序 32 个 float，再存 (bi, br) 交换后的 32 个
+// 实虚交换在打包时一次做完，内核里不再需要任何置换指令
+void cpack_b_panel(int kc, int nr, const float* B, int ldb, float* pb) {
+    __mmask16 m0 = tail_mask(2 * nr);
+    __mmask16 m1 = tail_mask(2 * nr - 16);
+    for (int k = 0; k < kc; k++) {
+        const float* b = B + (size_t)k * ldb * 2;
+        __m512 v0 = _mm512_maskz_loadu_ps(m0, b);
+        __m512 v1 = _mm512_maskz_loadu_ps(m1, b + 16);
+        _mm512_store_ps(pb, v0);
+        _mm512_store_ps(pb + 16, v1);
+        _mm512_store_ps(pb + 32, _mm512_permute_ps(v0, 0xB1));
+        _mm512_store_ps(pb + 48, _mm512_permute_ps(v1, 0xB1));
+        pb += 4 * CNR;
+    }
+}
+
+// 复数微内核：re 累加 ar * (br, bi)，im 累加 ai * (bi, br)
+// 结束时 fmaddsub(re, 1, im) 得到 (ar*br - ai*bi, ar*bi + ai*br)
+void cmicro_kernel(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr) {
+    __m512 re0[CMR], re1[CMR], im0[CMR], im1[CMR];
+    for (int r = 0; r < CMR; r++) {
+        re0[r] = _mm512_setzero_ps();
+        re1[r] = _mm512_setzero_ps();
+        im0[r] = _mm512_setzero_ps();
+        im1[r] = _mm512_setzero_ps();
+    }
+
+    for (int k = 0; k < kc; k++) {
+        __m512 b0 = _mm512_load_ps(pb);
+        __m512 b1 = _mm512_load_ps(pb + 16);
+        __m512 s0 = _mm512_load_ps(pb + 32);
+        __m512 s1 = _mm512_load_ps(pb + 48);
+        for (int r = 0; r < CMR; r++) {
+            __m512 ar = _mm512_set1_ps(pa[2 * r]);
+            __m512 ai = _mm512_set1_ps(pa[2 * r + 1]);
+            re0[r] = _mm512_fmadd_ps(ar, b0, re0[r]);
+            re1[r] = _mm512_fmadd_ps(ar, b1, re1[r]);
+            im0[r] = _mm512_fmadd_ps(ai, s0, im0[r]);
+            im1[r] = _mm512_fmadd_ps(ai, s1, im1[r]);
+        }
+        pa += 2 * CMR;
+        pb += 4 * CNR;
+    }
+
+    __m512 one = _mm512_set1_ps(1.0f);
+    __mmask16 m0 = tail_mask(2 * nr);
+    __mmask16 m1 = tail_mask(2 * nr - 16);
+    for (int r = 0; r < mr; r++) {
+        float* c = C + (size_t)r * ldc * 2;
+        __m512 v0 = _mm512_fmaddsub_ps(re0[r], one, im0[r]);
+        __m512 v1 = _mm512_fmaddsub_ps(re1[r], one, im1[r]);
+        _mm512_mask_storeu_ps(c, m0, _mm512_add_ps(v0, _mm512_maskz_loadu_ps(m0, c)));
+        _mm512_mask_storeu_ps(c + 16, m1, _mm512_add_ps(v1, _mm512_maskz_loadu_ps(m1, c + 16)));
+    }
+}
+
+// 原生复数 GEMM：C = A * B，分块与并行方式和实数版相同
+int cgemm_native(int m, int n, int k, const float* A, int lda, const float* B, int ldb, float* C, int ldc) {
+    float* pb = (float*)aligned_alloc(64, sizeof(float) * 4 * CKC_BLOCK * CNC_BLOCK);
+    if (!pb) return -1;
+    int failed = 0;
+
+    #pragma omp parallel
+    {
+        float* pa = (float*)aligned_alloc(64, sizeof(float) * 2 * CMC_BLOCK * CKC_BLOCK);
+        if (!pa) {
+            #pragma omp atomic write
+            failed = 1;
+        }
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < m; i++) memset(C + (size_t)i * ldc * 2, 0, sizeof(float) * 2 * n);
+
+        for (int jc = 0; jc < n; jc += CNC_BLOCK) {
+            int nc = min_int(CNC_BLOCK, n - jc);
+            for (int pc = 0; pc < k; pc += CKC_BLOCK) {
+                int kc = min_int(CKC_BLOCK, k - pc);
+                #pragma omp for schedule(static)
+                for (int jr = 0; jr < nc; jr += CNR) {
+                    cpack_b_panel(kc, min_int(CNR, nc - jr), B + ((size_t)pc * ldb + jc + jr) * 2, ldb,
+                                  pb + (size_t)jr * 4 * kc);
+                }
+                #pragma omp for schedule(dynamic)
+                for (int ic = 0; ic < m; ic += CMC_BLOCK) {
+                    if (!pa) continue;
+                    int mc = min_int(CMC_BLOCK, m - ic);
+                    cpack_a(mc, kc, A + ((size_t)ic * lda + pc) * 2, lda, pa);
+                    for (int jr = 0; jr < nc; jr += CNR) {
+                        for (int ir = 0; ir < mc; ir += CMR) {
+                            cmicro_kernel(kc, pa + (size_t)ir * 2 * kc, pb + (size_t)jr * 4 * kc,
+                                          C + ((size_t)(ic + ir) * ldc + jc + jr) * 2, ldc,
+                                          min_int(CMR, mc - ir), min_int(CNR, nc - jr));
+                        }
+                    }
+                }
+            }
+        }
+        free(pa);
+    }
+    free(pb);
+    return failed ? -1 : 0;
+}
+
+// 交错存储 -> 实部/虚部两个平面，sum 非空时顺便求 re + im
+static void split_planes(int rows, int cols, const float* X, int ld, float* re, float* im, float* sum) {
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            float r = X[((size_t)i * ld + j) * 2];
+            float v = X[((size_t)i * ld + j) * 2 + 1];
+            re[(size_t)i * cols + j] = r;
+            im[(size_t)i * cols + j] = v;
+            if (sum) sum[(size_t)i * cols + j] = r + v;
+        }
+    }
+}
+
+// 3M 算法：T1 = Ar*Br，T2 = Ai*Bi，T3 = (Ar+Ai)*(Br+Bi)
+// Cr = T1 - T2，Ci = T3 - T1 - T2，三次实数乘法代替四次，代价是多一些加法和平面拷贝
+int cgemm_3m(int m, int n, int k, const float* A, int lda, const float* B, int ldb, float* C, int ldc) {
+    size_t sa = (size_t)m * k, sb = (size_t)k * n, sc = (size_t)m * n;
+    float* buf = (float*)aligned_alloc(64, sizeof(float) * (3 * sa + 3 * sb + 3 * sc + 64));
+    if (!buf) return -1;
+    float *ar = buf, *ai = ar + sa, *as = ai + sa;
+    float *br = as + sa, *bi = br + sb, *bs = bi + sb;
+    float *t1 = bs + sb, *t2 = t1 + sc, *t3 = t2 + sc;
+
+    split_planes(m, k, A, lda, ar, ai, as);
+    split_planes(k, n, B, ldb, br, bi, bs);
+    int ret = sgemm(m, n, k, ar, k, br, n, t1, n);
+    if (!ret) ret = sgemm(m, n, k, ai, k, bi, n, t2, n);
+    if (!ret) ret = sgemm(m, n, k, as, k, bs, n, t3, n);
+
+    if (!ret) {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < n; j++) {
+                size_t p = (size_t)i * n + j;
+                C[((size_t)i * ldc + j) * 2] = t1[p] - t2[p];
+                C[((size_t)i * ldc + j) * 2 + 1] = t3[p] - t1[p] - t2[p];
+            }
+        }
+    }
+    free(buf);
+    return ret;
+}
+
+// CGEMM_AUTO 时实际采用的算法
+cgemm_algo cgemm_select(int m, int n, int k) {
+    return (m >= CGEMM_3M_MIN && n >= CGEMM_3M_MIN && k >= CGEMM_3M_MIN) ? CGEMM_3M : CGEMM_NATIVE;
+}
+
+// 复数 GEMM 入口：C[m x n] = A[m x k] * B[k x n]，三个矩阵都是交错存储
+int cgemm(int m, int n, int k, const float* A, int lda, const float* B, int ldb, float* C, int ldc,
+          cgemm_algo algo) {
+    if (algo == CGEMM_AUTO) algo = cgemm_select(m, n, k);
+    return algo == CGEMM_3M ? cgemm_3m(m, n, k, A, lda, B, ldb, C, ldc)
+                            : cgemm_native(m, n, k, A, lda, B, ldb, C, ldc);
+}
+
+// 对照组：拆成实部/虚部后做四次实数 GEMM
+int cgemm_4real(int m, int n, int k, const float* A, int lda, const float* B, int ldb, float* C, int ldc) {
+    size_t sa = (size_t)m * k, sb = (size_t)k * n, sc = (size_t)m * n;
+    float* buf = (float*)aligned_alloc(64, sizeof(float) * (2 * sa + 2 * sb + 4 * sc + 64));
+    if (!buf) return -1;
+    float *ar = buf, *ai = ar + sa, *br = ai + sa, *bi = br + sb;
+    float *rr = bi + sb, *ii = rr + sc, *ri = ii + sc, *ir = ri + sc;
+
+    split_planes(m, k, A, lda, ar, ai, NULL);
+    split_planes(k, n, B, ldb, br, bi, NULL);
+    int ret = sgemm(m, n, k, ar, k, br, n, rr, n);
+    if (!ret) ret = sgemm(m, n, k, ai, k, bi, n, ii, n);
+    if (!ret) ret = sgemm(m, n, k, ar, k, bi, n, ri, n);
+    if (!ret) ret = sgemm(m, n, k, ai, k, br, n, ir, n);
+
+    if (!ret) {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < n; j++) {
+                size_t p = (size_t)i * n + j;
+                C[((size_t)i * ldc + j) * 2] = rr[p] - ii[p];
+                C[((size_t)i * ldc + j) * 2 + 1] = ri[p] + ir[p];
+            }
+        }
+    }
+    free(buf);
+    return ret;
+}
+
+void init_matrix(float* M, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        M[i] = (float)rand() / RAND_MAX - 0.5f;
+    }
+}
+
+// 抽样若干位置与双精度复数参考值比较，误差相对于 sum |a||b|
+double check_result(int m, int n, int k, const float* A, const float* B, const float* C) {
+    double max_err = 0.0;
+    for (int s = 0; s < 64; s++) {
+        int i = rand() % m;
+        int j = rand() % n;
+        double re = 0.0, im = 0.0, mag = 0.0;
+        for (int p = 0; p < k; p++) {
+            double ar = A[((size_t)i * k + p) * 2], ai = A[((size_t)i * k + p) * 2 + 1];
+            double br = B[((size_t)p * n + j) * 2], bi = B[((size_t)p * n + j) * 2 + 1];
+            re += ar * br - ai * bi;
+            im += ar * bi + ai * br;
+            mag += hypot(ar, ai) * hypot(br, bi);
+        }
+        double dr = C[((size_t)i * n + j) * 2] - re;
+        double di = C[((size_t)i * n + j) * 2 + 1] - im;
+        double err = hypot(dr, di) / (mag + 1e-30);
+        if (err > max_err) max_err = err;
+    }
+    return max_err;
+}
+
+typedef int (*cgemm_fn)(int, int, int, const float*, int, const float*, int, float*, int);
+
+void bench_one(const char* name, cgemm_fn fn, int m, int n, int k, const float* A, const float* B, float* C) {
+    fn(m, n, k, A, k, B, n, C, n);
+    double t0 = now_sec();
+    if (fn(m, n, k, A, k, B, n, C, n)) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    double t = now_sec() - t0;
+    // 复数乘加按 8 次实数浮点运算计
+    double flops = 8.0 * m * n * k;
+    printf("  %-16s 计算时间: %.4f 秒  等效复数性能: %.2f GFLOPS  最大相对误差: %.2e\n",
+           name, t, flops / t / 1e9, check_result(m, n, k, A, B, C));
+}
+
+void bench_shape(int m, int n, int k) {
+    float* A = (float*)aligned_alloc(64, sizeof(float) * 2 * ((size_t)m * k + 16));
+    float* B = (float*)aligned_alloc(64, sizeof(float) * 2 * ((size_t)k * n + 16));
+    float* C = (float*)aligned_alloc(64, sizeof(float) * 2 * ((size_t)m * n + 16));
+    if (!A || !B || !C) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    init_matrix(A, 2 * (size_t)m * k);
+    init_matrix(B, 2 * (size_t)k * n);
+
+    printf("复数矩阵维度: M=%d N=%d K=%d\n", m, n, k);
+    bench_one("四次实数 GEMM", cgemm_4real, m, n, k, A, B, C);
+    bench_one("原生 CGEMM", cgemm_native, m, n, k, A, B, C);
+    bench_one("3M 算法", cgemm_3m, m, n, k, A, B, C);
+
+    free(A);
+    free(B);
+    free(C);
+}
+
+// 检查 CGEMM_AUTO：选择的算法符合预期，且结果与直接调用该算法逐位一致；通过返回 0
+int check_auto(int m, int n, int k, cgemm_algo expected) {
+    size_t sc = 2 * ((size_t)m * n + 16);
+    float* A = (float*)aligned_alloc(64, sizeof(float) * 2 * ((size_t)m * k + 16));
+    float* B = (float*)aligned_alloc(64, sizeof(float) * 2 * ((size_t)k * n + 16));
+    float* C = (float*)aligned_alloc(64, sizeof(float) * sc);
+    float* D = (float*)aligned_alloc(64, sizeof(float) * sc);
+    if (!A || !B || !C || !D) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    init_matrix(A, 2 * (size_t)m * k);
+    init_matrix(B, 2 * (size_t)k * n);
+
+    cgemm_algo chosen = cgemm_select(m, n, k);
+    int ret = cgemm(m, n, k, A, k, B, n, C, n, CGEMM_AUTO);
+    if (!ret) ret = chosen == CGEMM_3M ? cgemm_3m(m, n, k, A, k, B, n, D, n) : cgemm_native(m, n, k, A, k, B, n, D, n);
+    if (ret) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    int same = memcmp(C, D, sizeof(float) * 2 * (size_t)m * n) == 0;
+    double err = check_result(m, n, k, A, B, C);
+    int ok = chosen == expected && same && err < 1e-5;
+    printf("  M=%d N=%d K=%d  选择: %s (预期 %s)  与直接调用一致: %s  最大相对误差: %.2e  %s\n", m, n, k,
+           chosen == CGEMM_3M ? "3M 算法" : "原生 CGEMM", expected == CGEMM_3M ? "3M 算法" : "原生 CGEMM",
+           same ? "是" : "否", err, ok ? "通过" : "失败");
+
+    free(A);
+    free(B);
+    free(C);
+    free(D);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    printf("线程数: %d\n", omp_get_max_threads());
+
+    if (argc == 4) {
+        bench_shape(atoi(argv[1]), atoi(argv[2]), atoi(argv[3]));
+        return 0;
+    }
+    bench_shape(512, 512, 512);
+    bench_shape(1000, 1000, 1000);
+    bench_shape(2048, 2048, 2048);
+
+    // 自动选择：阈值以下走原生内核，三个维度都达到 CGEMM_3M_MIN 时走 3M
+    printf("CGEMM_AUTO 检查 (阈值 %d):\n", CGEMM_3M_MIN);
+    int failed = check_auto(1000, 1000, 1000, CGEMM_NATIVE);
+    failed += check_auto(CGEMM_3M_MIN, CGEMM_3M_MIN, CGEMM_3M_MIN, CGEMM_3M);
+    return failed ? EXIT_FAILURE : 0;
+}
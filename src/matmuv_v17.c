@@ -0,0 +1,499 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include <mpi.h>
+#include <immintrin.h>
+
+// 本地分块内核与 v16 的实数部分相同：8 行 x 32 列微内核，MC/KC/NC 三级分块
+#define MR 8
+#define NR 32
+#define MC_BLOCK 128
+#define KC_BLOCK 256
+#define NC_BLOCK 2048
+// SUMMA 每一步沿 K 方向广播的面板宽度，不超过 KC_BLOCK，一步的本地乘法只打包一次 B
+#define PANEL_WIDTH 256
+// 每个进程抽查的 C 元素个数
+#define CHECK_SAMPLES 16
+// 枚举的最大复制层数 (2.5D)
+#define MAX_LAYERS 8
+
+// 进程网格：c 层，每层 q x q；rank = layer * q * q + row * q + col
+// 同一行的进程组成 row_comm (按列号排序)，同一列的组成 col_comm (按行号排序)，
+// 不同层上位置相同的进程组成 depth_comm (按层号排序)
+typedef struct {
+    int q, c;
+    int row, col, layer;
+    MPI_Comm comm, row_comm, col_comm, depth_comm;
+} proc_grid;
+
+// 本进程持有的块：A 的 [i0, i0+mloc) x [ka0, ka0+ka)，B 的 [kb0, kb0+kb) x [j0, j0+nloc)，
+// C 的 [i0, i0+mloc) x [j0, j0+nloc)。数据在第 0 层生成，其余层在乘法开始时复制
+typedef struct {
+    int m, n, k;
+    int i0, j0, ka0, kb0;
+    int mloc, nloc, ka, kb;
+    float *A, *B, *C;
+} dist_matrix;
+
+// SUMMA 的一步：由第 owner 列 (A) / 第 owner 行 (B) 的进程广播本地 K 区间内 [off, off+width) 的面板
+typedef struct {
+    int owner, off, width;
+} summa_step;
+
+typedef struct {
+    int count;
+    summa_step* steps;
+} summa_plan;
+
+// 双缓冲的面板和本地内核的打包缓冲
+typedef struct {
+    float* apanel[2];
+    float* bpanel[2];
+    float* pa;
+    float* pb;
+} workspace;
+
+typedef struct {
+    double time, exposed, max_err;
+} run_result;
+
+static inline int min_int(int a, int b) { return a < b ? a : b; }
+
+// 把 n 均分成 q 段，第 i 段的起点
+static inline int part_start(int n, int q, int i) { return (int)((long)n * i / q); }
+
+static inline __mmask16 tail_mask(int n) {
+    if (n >= 16) return 0xFFFF;
+    if (n <= 0) return 0;
+    return (__mmask16)((1u << n) - 1);
+}
+
+// 矩阵元素由下标直接算出，各进程无需通信就能生成自己的块，也能独立校验结果
+static inline float a_elem(long i, long k) { return (float)((i * 31 + k * 17) % 97) / 97.0f - 0.5f; }
+static inline float b_elem(long k, long j) { return (float)((k * 13 + j * 29) % 89) / 89.0f - 0.5f; }
+
+// ---------------- 本地分块乘法 ----------------
+
+void pack_a(int mc, int kc, const float* A, int lda, float* pa) {
+    for (int i = 0; i < mc; i += MR) {
+        int mr = min_int(MR, mc - i);
+        for (int k = 0; k < kc; k++) {
+            for (int r = 0; r < mr; r++) pa[r] = A[(size_t)(i + r) * lda + k];
+            for (int r = mr; r < MR; r++) pa[r] = 0.0f;
+            pa += MR;
+        }
+    }
+}
+
+void pack_b_panel(int kc, int nr, const float* B, int ldb, float* pb) {
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int k = 0; k < kc; k++) {
+        const float* b = B + (size_t)k * ldb;
+        _mm512_store_ps(pb, _mm512_maskz_loadu_ps(m0, b));
+        _mm512_store_ps(pb + 16, _mm512_maskz_loadu_ps(m1, b + 16));
+        pb += NR;
+    }
+}
+
+void micro_kernel(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr) {
+    __m512 c0[MR], c1[MR];
+    for (int r = 0; r < MR; r++) {
+        c0[r] = _mm512_setzero_ps();
+        c1[r] = _mm512_setzero_ps();
+    }
+
+    for (int k = 0; k < kc; k++) {
+        __m512 b0 = _mm512_load_ps(pb);
+        __m512 b1 = _mm512_load_ps(pb + 16);
+        for (int r = 0; r < MR; r++) {
+            __m512 a = _mm512_set1_ps(pa[r]);
+            c0[r] = _mm512_fmadd_ps(a, b0, c0[r]);
+            c1[r] = _mm512_fmadd_ps(a, b1, c1[r]);
+        }
+        pa += MR;
+        pb += NR;
+    }
+
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int r = 0; r < mr; r++) {
+        float* c = C + (size_t)r * ldc;
+        _mm512_mask_storeu_ps(c, m0, _mm512_add_ps(c0[r], _mm512_maskz_loadu_ps(m0, c)));
+        _mm512_mask_storeu_ps(c + 16, m1, _mm512_add_ps(c1[r], _mm512_maskz_loadu_ps(m1, c + 16)));
+    }
+}
+
+// MPI 至少支持 MPI_THREAD_FUNNELED 时才能在并行区内由主线程调用 MPI，否则只在并行区外等待通信
+static int g_test_in_region = 1;
+
+// C += A * B，按 v9 的方式在行块上并行
+// 非阻塞广播只有在 MPI 被调用时才会推进，所以主线程每算完一个行块就 MPI_Testall 一次下一步的请求
+void local_gemm(int m, int n, int k, const float* A, int lda, const float* B, int ldb,
+                float* C, int ldc, workspace* ws, MPI_Request* reqs, int nreq) {
+    #pragma omp parallel
+    {
+        float* pa = ws->pa + (size_t)omp_get_thread_num() * MC_BLOCK * KC_BLOCK;
+        for (int jc = 0; jc < n; jc += NC_BLOCK) {
+            int nc = min_int(NC_BLOCK, n - jc);
+            for (int pc = 0; pc < k; pc += KC_BLOCK) {
+                int kc = min_int(KC_BLOCK, k - pc);
+                #pragma omp for schedule(static)
+                for (int jr = 0; jr < nc; jr += NR) {
+                    pack_b_panel(kc, min_int(NR, nc - jr), B + (size_t)pc * ldb + jc + jr, ldb, ws->pb + jr * kc);
+                }
+                #pragma omp for schedule(dynamic)
+                for (int ic = 0; ic < m; ic += MC_BLOCK) {
+                    if (nreq && g_test_in_region && omp_get_thread_num() == 0) {
+                        int done;
+                        MPI_Testall(nreq, reqs, &done, MPI_STATUSES_IGNORE);
+                    }
+                    int mc = min_int(MC_BLOCK, m - ic);
+                    pack_a(mc, kc, A + (size_t)ic * lda + pc, lda, pa);
+                    for (int jr = 0; jr < nc; jr += NR) {
+                        for (int ir = 0; ir < mc; ir += MR) {
+                            micro_kernel(kc, pa + ir * kc, ws->pb + jr * kc,
+                                         C + (size_t)(ic + ir) * ldc + jc + jr, ldc,
+                                         min_int(MR, mc - ir), min_int(NR, nc - jr));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// ---------------- 进程网格与数据分布 ----------------
+
+void grid_create(proc_grid* g, MPI_Comm comm, int q, int c) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    g->q = q;
+    g->c = c;
+    g->comm = comm;
+    g->layer = rank / (q * q);
+    g->row = rank % (q * q) / q;
+    g->col = rank % q;
+    MPI_Comm_split(comm, g->layer * q + g->row, g->col, &g->row_comm);
+    MPI_Comm_split(comm, g->layer * q + g->col, g->row, &g->col_comm);
+    MPI_Comm_split(comm, g->row * q + g->col, g->layer, &g->depth_comm);
+}
+
+void grid_destroy(proc_grid* g) {
+    MPI_Comm_free(&g->row_comm);
+    MPI_Comm_free(&g->col_comm);
+    MPI_Comm_free(&g->depth_comm);
+}
+
+// 分配本进程的块；第 0 层按公式填入 A、B
+int dist_create(dist_matrix* d, const proc_grid* g, int m, int n, int k) {
+    int q = g->q;
+    d->m = m;
+    d->n = n;
+    d->k = k;
+    d->i0 = part_start(m, q, g->row);
+    d->mloc = part_start(m, q, g->row + 1) - d->i0;
+    d->j0 = part_start(n, q, g->col);
+    d->nloc = part_start(n, q, g->col + 1) - d->j0;
+    d->ka0 = part_start(k, q, g->col);
+    d->ka = part_start(k, q, g->col + 1) - d->ka0;
+    d->kb0 = part_start(k, q, g->row);
+    d->kb = part_start(k, q, g->row + 1) - d->kb0;
+
+    d->A = (float*)aligned_alloc(64, sizeof(float) * ((size_t)d->mloc * d->ka + 16));
+    d->B = (float*)aligned_alloc(64, sizeof(float) * ((size_t)d->kb * d->nloc + 16));
+    d->C = (float*)aligned_alloc(64, sizeof(float) * ((size_t)d->mloc * d->nloc + 16));
+    if (!d->A || !d->B || !d->C) return -1;
+
+    if (g->layer == 0) {
+        for (int i = 0; i < d->mloc; i++) {
+            for (int p = 0; p < d->ka; p++) d->A[(size_t)i * d->ka + p] = a_elem(d->i0 + i, d->ka0 + p);
+        }
+        for (int p = 0; p < d->kb; p++) {
+            for (int j = 0; j < d->nloc; j++) d->B[(size_t)p * d->nloc + j] = b_elem(d->kb0 + p, d->j0 + j);
+        }
+    }
+    return 0;
+}
+
+void dist_destroy(dist_matrix* d) {
+    free(d->A);
+    free(d->B);
+    free(d->C);
+}
+
+// 把 K 按网格的 q 段切开，每段再按 PANEL_WIDTH 切成面板，保证一个面板只属于一个进程
+int plan_create(summa_plan* plan, int k, int q) {
+    plan->count = 0;
+    for (int p = 0; p < q; p++) {
+        int len = part_start(k, q, p + 1) - part_start(k, q, p);
+        plan->count += (len + PANEL_WIDTH - 1) / PANEL_WIDTH;
+    }
+    plan->steps = (summa_step*)malloc(sizeof(summa_step) * (plan->count + 1));
+    if (!plan->steps) return -1;
+
+    int s = 0;
+    for (int p = 0; p < q; p++) {
+        int len = part_start(k, q, p + 1) - part_start(k, q, p);
+        for (int off = 0; off < len; off += PANEL_WIDTH) {
+            plan->steps[s].owner = p;
+            plan->steps[s].off = off;
+            plan->steps[s].width = min_int(PANEL_WIDTH, len - off);
+            s++;
+        }
+    }
+    return 0;
+}
+
+int workspace_create(workspace* ws, const dist_matrix* d) {
+    for (int b = 0; b < 2; b++) {
+        ws->apanel[b] = (float*)aligned_alloc(64, sizeof(float) * ((size_t)d->mloc * PANEL_WIDTH + 16));
+        ws->bpanel[b] = (float*)aligned_alloc(64, sizeof(float) * ((size_t)PANEL_WIDTH * d->nloc + 16));
+        if (!ws->apanel[b] || !ws->bpanel[b]) return -1;
+    }
+    ws->pa = (float*)aligned_alloc(64, sizeof(float) * MC_BLOCK * KC_BLOCK * omp_get_max_threads());
+    ws->pb = (float*)aligned_alloc(64, sizeof(float) * KC_BLOCK * NC_BLOCK);
+    return ws->pa && ws->pb ? 0 : -1;
+}
+
+void workspace_destroy(workspace* ws) {
+    for (int b = 0; b < 2; b++) {
+        free(ws->apanel[b]);
+        free(ws->bpanel[b]);
+    }
+    free(ws->pa);
+    free(ws->pb);
+}
+
+// ---------------- SUMMA ----------------
+
+// 发起一步的两个广播：A 面板沿行 (根为第 owner 列)，B 面板沿列 (根为第 owner 行)
+// A 的面板在本地块里是跨步的，根进程先把它拷成连续的
+void post_panels(const proc_grid* g, const dist_matrix* d, const summa_step* s,
+                 float* apanel, float* bpanel, MPI_Request req[2]) {
+    int w = s->width;
+    if (g->col == s->owner) {
+        for (int i = 0; i < d->mloc; i++) {
+            memcpy(apanel + (size_t)i * w, d->A + (size_t)i * d->ka + s->off, sizeof(float) * w);
+        }
+    }
+    MPI_Ibcast(apanel, d->mloc * w, MPI_FLOAT, s->owner, g->row_comm, &req[0]);
+
+    if (g->row == s->owner) {
+        memcpy(bpanel, d->B + (size_t)s->off * d->nloc, sizeof(float) * w * d->nloc);
+    }
+    MPI_Ibcast(bpanel, w * d->nloc, MPI_FLOAT, s->owner, g->col_comm, &req[1]);
+}
+
+// 分布式 C = A * B；c > 1 时为 2.5D：第 0 层先把 A、B 复制到各层，
+// 第 l 层只做编号 l, l + c, l + 2c, ... 的步骤，最后沿深度方向把部分和归约回第 0 层
+// 返回总时间，*exposed 为本进程阻塞在通信上的时间 (复制、等待面板、归约)
+double summa_multiply(const proc_grid* g, dist_matrix* d, const summa_plan* plan, workspace* ws,
+                      double* exposed) {
+    double wait = 0.0;
+    double t0 = MPI_Wtime();
+
+    if (g->c > 1) {
+        MPI_Bcast(d->A, d->mloc * d->ka, MPI_FLOAT, 0, g->depth_comm);
+        MPI_Bcast(d->B, d->kb * d->nloc, MPI_FLOAT, 0, g->depth_comm);
+        wait += MPI_Wtime() - t0;
+    }
+    memset(d->C, 0, sizeof(float) * d->mloc * d->nloc);
+
+    // 双缓冲流水线：等到第 s 步的面板后立刻发起下一步的广播，再用第 s 步的面板做本地乘法
+    MPI_Request req[2][2];
+    int cur = 0;
+    int s = g->layer;
+    if (s < plan->count) post_panels(g, d, &plan->steps[s], ws->apanel[0], ws->bpanel[0], req[0]);
+    for (; s < plan->count; s += g->c) {
+        double tw = MPI_Wtime();
+        MPI_Waitall(2, req[cur], MPI_STATUSES_IGNORE);
+        wait += MPI_Wtime() - tw;
+
+        int nreq = 0;
+        if (s + g->c < plan->count) {
+            post_panels(g, d, &plan->steps[s + g->c], ws->apanel[1 - cur], ws->bpanel[1 - cur], req[1 - cur]);
+            nreq = 2;
+        }
+        int w = plan->steps[s].width;
+        local_gemm(d->mloc, d->nloc, w, ws->apanel[cur], w, ws->bpanel[cur], d->nloc,
+                   d->C, d->nloc, ws, req[1 - cur], nreq);
+        cur = 1 - cur;
+    }
+
+    if (g->c > 1) {
+        double tw = MPI_Wtime();
+        MPI_Reduce(g->layer == 0 ? MPI_IN_PLACE : d->C, d->C, d->mloc * d->nloc, MPI_FLOAT,
+                   MPI_SUM, 0, g->depth_comm);
+        wait += MPI_Wtime() - tw;
+    }
+
+    *exposed = wait;
+    return MPI_Wtime() - t0;
+}
+
+// 第 0 层抽查本地 C 块，误差相对于 sum |a||b|
+double check_result(const proc_grid* g, const dist_matrix* d) {
+    double max_err = 0.0;
+    if (g->layer != 0 || d->mloc == 0 || d->nloc == 0) return 0.0;
+    unsigned seed = 12345u + g->row * 131u + g->col;
+    for (int s = 0; s < CHECK_SAMPLES; s++) {
+        int i = rand_r(&seed) % d->mloc;
+        int j = rand_r(&seed) % d->nloc;
+        double ref = 0.0, scale = 0.0;
+        for (int p = 0; p < d->k; p++) {
+            double a = a_elem(d->i0 + i, p);
+            double b = b_elem(p, d->j0 + j);
+            ref += a * b;
+            scale += fabs(a * b);
+        }
+        double err = fabs(d->C[(size_t)i * d->nloc + j] - ref) / (scale + 1e-30);
+        if (err > max_err) max_err = err;
+    }
+    return max_err;
+}
+
+// 在 comm 上以 q x q x c 网格计算 n x n x n，预热一次后取 reps 次中最快的一次
+run_result summa_bench(MPI_Comm comm, int q, int c, int n, int reps) {
+    proc_grid g;
+    dist_matrix d;
+    summa_plan plan;
+    workspace ws;
+    grid_create(&g, comm, q, c);
+    if (dist_create(&d, &g, n, n, n) || plan_create(&plan, n, q) || workspace_create(&ws, &d)) {
+        fprintf(stderr, "内存分配失败\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    run_result best = {1e30, 0.0, 0.0};
+    for (int r = 0; r <= reps; r++) {
+        double exposed;
+        MPI_Barrier(comm);
+        double t = summa_multiply(&g, &d, &plan, &ws, &exposed);
+        // 以最慢的进程为准
+        double tmax, emax;
+        MPI_Allreduce(&t, &tmax, 1, MPI_DOUBLE, MPI_MAX, comm);
+        MPI_Allreduce(&exposed, &emax, 1, MPI_DOUBLE, MPI_MAX, comm);
+        if (r > 0 && tmax < best.time) {
+            best.time = tmax;
+            best.exposed = emax;
+        }
+    }
+    double err = check_result(&g, &d);
+    MPI_Allreduce(&err, &best.max_err, 1, MPI_DOUBLE, MPI_MAX, comm);
+
+    workspace_destroy(&ws);
+    free(plan.steps);
+    dist_destroy(&d);
+    grid_destroy(&g);
+    return best;
+}
+
+// 不参与本轮的进程在这里睡眠等待，单机超额订阅时不会忙等抢走计算进程的 CPU
+void relaxed_barrier(MPI_Comm comm) {
+    MPI_Request req;
+    int done = 0;
+    struct timespec ts = {0, 1000000};
+    MPI_Ibarrier(comm, &req);
+    while (1) {
+        MPI_Test(&req, &done, MPI_STATUS_IGNORE);
+        if (done) break;
+        nanosleep(&ts, NULL);
+    }
+}
+
+// 用前 q * q * c 个进程跑一轮，其余进程空闲
+run_result run_on_subset(int q, int c, int n, int reps) {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    int p = q * q * c;
+    MPI_Comm sub;
+    MPI_Comm_split(MPI_COMM_WORLD, rank < p ? 0 : MPI_UNDEFINED, rank, &sub);
+
+    run_result res = {0.0, 0.0, 0.0};
+    if (sub != MPI_COMM_NULL) {
+        res = summa_bench(sub, q, c, n, reps);
+        MPI_Comm_free(&sub);
+    }
+    relaxed_barrier(MPI_COMM_WORLD);
+    return res;
+}
+
+int main(int argc, char** argv) {
+    int provided, rank, size;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (provided < MPI_THREAD_FUNNELED) {
+        g_test_in_region = 0;
+        if (rank == 0) {
+            printf("警告: MPI 线程支持级别不足 MPI_THREAD_FUNNELED，计算期间不再推进广播，通信无法与计算重叠\n");
+        }
+    }
+
+    // 用法: mpirun -np P matmuv_v17 [强扩展维度] [弱扩展单进程维度] [最大复制层数]
+    int n_strong = argc > 1 ? atoi(argv[1]) : 2048;
+    int n_weak = argc > 2 ? atoi(argv[2]) : 1024;
+    int max_layers = argc > 3 ? atoi(argv[3]) : 4;
+    int reps = 3;
+    if (max_layers > MAX_LAYERS) max_layers = MAX_LAYERS;
+
+    // 枚举所有能放进 size 个进程的 q x q x c 网格 (c 取 2 的幂)，按进程数排序
+    int grid_q[64], grid_c[64], count = 0;
+    for (int p = 1; p <= size && count < 64; p++) {
+        for (int c = 1; c <= max_layers && count < 64; c *= 2) {
+            int q = (int)lround(sqrt((double)p / c));
+            if (q >= 1 && q * q * c == p) {
+                grid_q[count] = q;
+                grid_c[count] = c;
+                count++;
+            }
+        }
+    }
+
+    if (rank == 0) {
+        printf("MPI 进程数: %d  每进程线程数: %d  面板宽度: %d\n", size, omp_get_max_threads(), PANEL_WIDTH);
+        printf("强扩展 (M=N=K=%d):\n", n_strong);
+        printf("  %6s %10s %10s %10s %8s %8s %14s %12s\n",
+               "进程数", "网格", "时间(秒)", "GFLOPS", "加速比", "效率", "通信暴露(秒)", "最大相对误差");
+    }
+    double t1 = 0.0;
+    for (int g = 0; g < count; g++) {
+        int p = grid_q[g] * grid_q[g] * grid_c[g];
+        run_result r = run_on_subset(grid_q[g], grid_c[g], n_strong, reps);
+        if (rank == 0) {
+            if (p == 1) t1 = r.time;
+            char shape[32];
+            snprintf(shape, sizeof(shape), "%dx%dx%d", grid_q[g], grid_q[g], grid_c[g]);
+            printf("  %6d %10s %10.4f %10.2f %8.2f %7.1f%% %14.4f %12.2e\n",
+                   p, shape, r.time, 2.0 * n_strong * n_strong * n_strong / r.time / 1e9,
+                   t1 / r.time, 100.0 * t1 / r.time / p, r.exposed, r.max_err);
+        }
+    }
+
+    // 弱扩展：每进程的计算量固定为 n_weak^3，全局维度取 n_weak * cbrt(P)
+    if (rank == 0) {
+        printf("弱扩展 (每进程计算量 %d^3):\n", n_weak);
+        printf("  %6s %10s %8s %10s %10s %8s %14s %12s\n",
+               "进程数", "网格", "维度", "时间(秒)", "GFLOPS", "效率", "通信暴露(秒)", "最大相对误差");
+    }
+    for (int g = 0; g < count; g++) {
+        int p = grid_q[g] * grid_q[g] * grid_c[g];
+        int n = (int)lround(n_weak * cbrt((double)p));
+        run_result r = run_on_subset(grid_q[g], grid_c[g], n, reps);
+        if (rank == 0) {
+            if (p == 1) t1 = r.time;
+            char shape[32];
+            snprintf(shape, sizeof(shape), "%dx%dx%d", grid_q[g], grid_q[g], grid_c[g]);
+            printf("  %6d %10s %8d %10.4f %10.2f %7.1f%% %14.4f %12.2e\n",
+                   p, shape, n, r.time, 2.0 * n * n * n / r.time / 1e9,
+                   100.0 * t1 / r.time, r.exposed, r.max_err);
+        }
+    }
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,935 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <omp.h>
+#include <immintrin.h>
+
+// 打包内核的寄存器分块与缓存分块 (同 v16 实数部分)
+#define MR 8
+#define NR 32
+#define KC_BLOCK 256
+#define NC_BLOCK 2048
+#define MAX_MC 256
+// 小矩阵内核每行一次处理的列数 (4 个 zmm)
+#define SMALL_NB 64
+// 调度器支持的最大线程数
+#define MAX_THREADS 64
+// 决策缓存的槽数 (2 的幂)，装到 3/4 后每次未命中淘汰最久未使用的一项
+#define CACHE_SLOTS 1024
+// 实测调优时只实测代价模型排名靠前的几个候选
+#define TUNE_CANDIDATES 5
+// 取不到 L2 容量时的默认值
+#define DEFAULT_L2_BYTES (1 << 20)
+
+typedef enum { DTYPE_F32, DTYPE_F64 } dtype;
+typedef enum { LAYOUT_ROW_MAJOR, LAYOUT_COL_MAJOR } layout;
+typedef enum { KERNEL_SMALL, KERNEL_GEMV, KERNEL_PACKED, KERNEL_SPLIT_K, KERNEL_DBLOCKED } kernel_kind;
+typedef enum { SOURCE_MODEL, SOURCE_MEASURED, SOURCE_FIXED } plan_source;
+
+// 一次调用的执行方案：内核、线程数与分块 (mc 用于打包内核，kc 用于双精度内核)
+typedef struct {
+    kernel_kind kernel;
+    int threads;
+    int mc, kc;
+    double predicted;
+    plan_source source;
+} gemm_plan;
+
+typedef struct {
+    int used;
+    long last_use;
+    int m, n, k;
+    dtype dt;
+    layout lo;
+    gemm_plan plan;
+} cache_entry;
+
+// 代价模型的标定结果：各内核的单线程速率、并行区开销和内存带宽
+typedef struct {
+    int calibrated;
+    int max_threads;
+    size_t l2_bytes;
+    double fork_cost[MAX_THREADS + 1];
+    double small_rate, packed_rate, dbl_rate;
+    // 全部线程相对单线程的实测加速比，线程数超过物理核数时远小于线程数
+    double cores;
+    double call_cost[KERNEL_DBLOCKED + 1];
+    double bw1, bw_max;
+} dispatch_model;
+
+// 代价模型、方案缓存和缓冲区都是全局状态且不加锁，不是线程安全的：
+// dispatch_plan / dispatch_tune / gemm_dispatch 同一时刻只能由一个线程调用 (内核内部的 OpenMP 并行不受影响)
+static dispatch_model g_model;
+static cache_entry g_cache[CACHE_SLOTS];
+static int g_cache_count;
+static long g_cache_tick;
+static long g_cache_hits, g_cache_misses;
+// 长期持有的缓冲区：0 号给共享的 B 面板，1 号给 GEMV 的连续 x，之后每线程三个 (A 块、B 面板、部分和)
+static float* g_scratch[2 + 3 * MAX_THREADS];
+static size_t g_scratch_cap[2 + 3 * MAX_THREADS];
+
+enum { SCRATCH_PB = 0, SCRATCH_X = 1 };
+static inline int scratch_slot(int tid, int which) { return 2 + 3 * tid + which; }
+
+static const char* kernel_name(kernel_kind kernel) {
+    switch (kernel) {
+        case KERNEL_SMALL:    return "小矩阵";
+        case KERNEL_GEMV:     return "GEMV";
+        case KERNEL_PACKED:   return "打包";
+        case KERNEL_SPLIT_K:  return "split-K";
+        case KERNEL_DBLOCKED: return "双精度分块";
+    }
+    return "?";
+}
+
+static const char* source_name(plan_source source) {
+    switch (source) {
+        case SOURCE_MODEL:    return "模型";
+        case SOURCE_MEASURED: return "实测";
+        case SOURCE_FIXED:    return "固定";
+    }
+    return "?";
+}
+
+static inline int min_int(int a, int b) { return a < b ? a : b; }
+static inline int max_int(int a, int b) { return a > b ? a : b; }
+static inline int ceil_div(int a, int b) { return (a + b - 1) / b; }
+
+static inline __mmask16 tail_mask(int n) {
+    if (n >= 16) return 0xFFFF;
+    if (n <= 0) return 0;
+    return (__mmask16)((1u << n) - 1);
+}
+
+static inline __mmask8 tail_mask8(int n) {
+    if (n >= 8) return 0xFF;
+    if (n <= 0) return 0;
+    return (__mmask8)((1u << n) - 1);
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 只增不减的缓冲区，重复调用不再分配，也不会反复触发缺页
+static float* scratch_get(int slot, size_t count) {
+    if (g_scratch_cap[slot] < count) {
+        free(g_scratch[slot]);
+        g_scratch[slot] = (float*)aligned_alloc(64, sizeof(float) * (count + 16));
+        if (!g_scratch[slot]) {
+            fprintf(stderr, "内存分配失败\n");
+            exit(EXIT_FAILURE);
+        }
+        g_scratch_cap[slot] = count;
+    }
+    return g_scratch[slot];
+}
+
+// ---------------- 单精度内核 ----------------
+
+// 不打包的小矩阵内核：每行一次算 64 列，B 整块留在缓存里
+static void small_rows(int i0, int i1, int n, int k, const float* A, int lda, const float* B, int ldb,
+                       float* C, int ldc) {
+    for (int i = i0; i < i1; i++) {
+        const float* a = A + (size_t)i * lda;
+        float* c = C + (size_t)i * ldc;
+        for (int j = 0; j < n; j += SMALL_NB) {
+            __mmask16 m0 = tail_mask(n - j), m1 = tail_mask(n - j - 16);
+            __mmask16 m2 = tail_mask(n - j - 32), m3 = tail_mask(n - j - 48);
+            __m512 c0 = _mm512_setzero_ps(), c1 = _mm512_setzero_ps();
+            __m512 c2 = _mm512_setzero_ps(), c3 = _mm512_setzero_ps();
+            for (int p = 0; p < k; p++) {
+                const float* b = B + (size_t)p * ldb + j;
+                __m512 av = _mm512_set1_ps(a[p]);
+                c0 = _mm512_fmadd_ps(av, _mm512_maskz_loadu_ps(m0, b), c0);
+                c1 = _mm512_fmadd_ps(av, _mm512_maskz_loadu_ps(m1, b + 16), c1);
+                c2 = _mm512_fmadd_ps(av, _mm512_maskz_loadu_ps(m2, b + 32), c2);
+                c3 = _mm512_fmadd_ps(av, _mm512_maskz_loadu_ps(m3, b + 48), c3);
+            }
+            _mm512_mask_storeu_ps(c + j, m0, c0);
+            _mm512_mask_storeu_ps(c + j + 16, m1, c1);
+            _mm512_mask_storeu_ps(c + j + 32, m2, c2);
+            _mm512_mask_storeu_ps(c + j + 48, m3, c3);
+        }
+    }
+}
+
+// 单线程时直接调用，连 if(0) 的并行区也不进，小矩阵上这部分开销不可忽略
+void small_gemm(int m, int n, int k, const float* A, int lda, const float* B, int ldb,
+                float* C, int ldc, int threads) {
+    if (threads == 1) {
+        small_rows(0, m, n, k, A, lda, B, ldb, C, ldc);
+        return;
+    }
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num(), nt = omp_get_num_threads();
+        small_rows((long)m * t / nt, (long)m * (t + 1) / nt, n, k, A, lda, B, ldb, C, ldc);
+    }
+}
+
+// y = A * x 的 [i0, i1) 行，x 连续；每行四个累加器
+static void gemv_range(int i0, int i1, int k, const float* A, int lda, const float* x, float* y, int incy) {
+    for (int i = i0; i < i1; i++) {
+        const float* a = A + (size_t)i * lda;
+        __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+        __m512 s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps();
+        int p = 0;
+        for (; p + 64 <= k; p += 64) {
+            s0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + p), _mm512_loadu_ps(x + p), s0);
+            s1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + p + 16), _mm512_loadu_ps(x + p + 16), s1);
+            s2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + p + 32), _mm512_loadu_ps(x + p + 32), s2);
+            s3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + p + 48), _mm512_loadu_ps(x + p + 48), s3);
+        }
+        for (; p < k; p += 16) {
+            __mmask16 mask = tail_mask(k - p);
+            s0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + p), _mm512_maskz_loadu_ps(mask, x + p), s0);
+        }
+        y[(size_t)i * incy] = _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(s0, s1), _mm512_add_ps(s2, s3)));
+    }
+}
+
+void gemv_rows(int m, int k, const float* A, int lda, const float* x, float* y, int incy, int threads) {
+    if (threads == 1) {
+        gemv_range(0, m, k, A, lda, x, y, incy);
+        return;
+    }
+    #pragma omp parallel num_threads(threads)
+    {
+        int t = omp_get_thread_num(), nt = omp_get_num_threads();
+        gemv_range((long)m * t / nt, (long)m * (t + 1) / nt, k, A, lda, x, y, incy);
+    }
+}
+
+void pack_a(int mc, int kc, const float* A, int lda, float* pa) {
+    for (int i = 0; i < mc; i += MR) {
+        int mr = min_int(MR, mc - i);
+        for (int k = 0; k < kc; k++) {
+            for (int r = 0; r < mr; r++) pa[r] = A[(size_t)(i + r) * lda + k];
+            for (int r = mr; r < MR; r++) pa[r] = 0.0f;
+            pa += MR;
+        }
+    }
+}
+
+void pack_b_panel(int kc, int nr, const float* B, int ldb, float* pb) {
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int k = 0; k < kc; k++) {
+        const float* b = B + (size_t)k * ldb;
+        _mm512_store_ps(pb, _mm512_maskz_loadu_ps(m0, b));
+        _mm512_store_ps(pb + 16, _mm512_maskz_loadu_ps(m1, b + 16));
+        pb += NR;
+    }
+}
+
+void micro_kernel(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr) {
+    __m512 c0[MR], c1[MR];
+    for (int r = 0; r < MR; r++) {
+        c0[r] = _mm512_setzero_ps();
+        c1[r] = _mm512_setzero_ps();
+    }
+
+    for (int k = 0; k < kc; k++) {
+        __m512 b0 = _mm512_load_ps(pb);
+        __m512 b1 = _mm512_load_ps(pb + 16);
+        for (int r = 0; r < MR; r++) {
+            __m512 a = _mm512_set1_ps(pa[r]);
+            c0[r] = _mm512_fmadd_ps(a, b0, c0[r]);
+            c1[r] = _mm512_fmadd_ps(a, b1, c1[r]);
+        }
+        pa += MR;
+        pb += NR;
+    }
+
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int r = 0; r < mr; r++) {
+        float* c = C + (size_t)r * ldc;
+        _mm512_mask_storeu_ps(c, m0, _mm512_add_ps(c0[r], _mm512_maskz_loadu_ps(m0, c)));
+        _mm512_mask_storeu_ps(c + 16, m1, _mm512_add_ps(c1[r], _mm512_maskz_loadu_ps(m1, c + 16)));
+    }
+}
+
+// 单线程打包乘法：C += A * B
+static void packed_serial(int m, int n, int k, const float* A, int lda, const float* B, int ldb,
+                          float* C, int ldc, int mc_block, float* pa, float* pb) {
+    for (int jc = 0; jc < n; jc += NC_BLOCK) {
+        int nc = min_int(NC_BLOCK, n - jc);
+        for (int pc = 0; pc < k; pc += KC_BLOCK) {
+            int kc = min_int(KC_BLOCK, k - pc);
+            for (int jr = 0; jr < nc; jr += NR) {
+                pack_b_panel(kc, min_int(NR, nc - jr), B + (size_t)pc * ldb + jc + jr, ldb, pb + jr * kc);
+            }
+            for (int ic = 0; ic < m; ic += mc_block) {
+                int mc = min_int(mc_block, m - ic);
+                pack_a(mc, kc, A + (size_t)ic * lda + pc, lda, pa);
+                for (int jr = 0; jr < nc; jr += NR) {
+                    for (int ir = 0; ir < mc; ir += MR) {
+                        micro_kernel(kc, pa + ir * kc, pb + jr * kc, C + (size_t)(ic + ir) * ldc + jc + jr, ldc,
+                                     min_int(MR, mc - ir), min_int(NR, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 打包乘法 C = A * B：与 v9 一样按行块并行，B 面板由参与的线程共同打包后共享
+// 行块大小 mc_block 决定可并行的份数，M 较小时调小它才能让更多线程有活干
+void packed_gemm(int m, int n, int k, const float* A, int lda, const float* B, int ldb,
+                 float* C, int ldc, int mc_block, int threads) {
+    float* pb = scratch_get(SCRATCH_PB, (size_t)KC_BLOCK * NC_BLOCK);
+    if (threads == 1) {
+        float* pa = scratch_get(scratch_slot(0, 0), (size_t)mc_block * KC_BLOCK);
+        for (int i = 0; i < m; i++) memset(C + (size_t)i * ldc, 0, sizeof(float) * n);
+        packed_serial(m, n, k, A, lda, B, ldb, C, ldc, mc_block, pa, pb);
+        return;
+    }
+
+    #pragma omp parallel num_threads(threads)
+    {
+        float* pa = scratch_get(scratch_slot(omp_get_thread_num(), 0), (size_t)mc_block * KC_BLOCK);
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < m; i++) memset(C + (size_t)i * ldc, 0, sizeof(float) * n);
+
+        for (int jc = 0; jc < n; jc += NC_BLOCK) {
+            int nc = min_int(NC_BLOCK, n - jc);
+            for (int pc = 0; pc < k; pc += KC_BLOCK) {
+                int kc = min_int(KC_BLOCK, k - pc);
+                #pragma omp for schedule(static)
+                for (int jr = 0; jr < nc; jr += NR) {
+                    pack_b_panel(kc, min_int(NR, nc - jr), B + (size_t)pc * ldb + jc + jr, ldb, pb + jr * kc);
+                }
+                #pragma omp for schedule(dynamic)
+                for (int ic = 0; ic < m; ic += mc_block) {
+                    int mc = min_int(mc_block, m - ic);
+                    pack_a(mc, kc, A + (size_t)ic * lda + pc, lda, pa);
+                    for (int jr = 0; jr < nc; jr += NR) {
+                        for (int ir = 0; ir < mc; ir += MR) {
+                            micro_kernel(kc, pa + ir * kc, pb + jr * kc,
+                                         C + (size_t)(ic + ir) * ldc + jc + jr, ldc,
+                                         min_int(MR, mc - ir), min_int(NR, nc - jr));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// split-K：每个线程按 KC_BLOCK 对齐分到一段 K，各自打包计算，0 号线程直接写 C，其余写部分和，最后按行归约
+void split_k_gemm(int m, int n, int k, const float* A, int lda, const float* B, int ldb,
+                  float* C, int ldc, int mc_block, int threads) {
+    float* parts[MAX_THREADS];
+
+    #pragma omp parallel num_threads(threads) if(threads > 1)
+    {
+        int t = omp_get_thread_num();
+        int nt = omp_get_num_threads();
+        int kb = ceil_div(k, KC_BLOCK);
+        int k0 = min_int(k, kb * t / nt * KC_BLOCK);
+        int k1 = min_int(k, kb * (t + 1) / nt * KC_BLOCK);
+        float* pa = scratch_get(scratch_slot(t, 0), (size_t)mc_block * KC_BLOCK);
+        float* pb = scratch_get(scratch_slot(t, 1), (size_t)KC_BLOCK * NC_BLOCK);
+        float* part = t == 0 ? C : scratch_get(scratch_slot(t, 2), (size_t)m * n);
+        int ldp = t == 0 ? ldc : n;
+        parts[t] = part;
+
+        for (int i = 0; i < m; i++) memset(part + (size_t)i * ldp, 0, sizeof(float) * n);
+        packed_serial(m, n, k1 - k0, A + k0, lda, B + (size_t)k0 * ldb, ldb, part, ldp, mc_block, pa, pb);
+
+        #pragma omp barrier
+        #pragma omp for schedule(static)
+        for (int i = 0; i < m; i++) {
+            float* c = C + (size_t)i * ldc;
+            for (int s = 1; s < nt; s++) {
+                const float* p = parts[s] + (size_t)i * n;
+                for (int j = 0; j < n; j += 16) {
+                    __mmask16 mask = tail_mask(n - j);
+                    _mm512_mask_storeu_ps(c + j, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, c + j),
+                                                                     _mm512_maskz_loadu_ps(mask, p + j)));
+                }
+            }
+        }
+    }
+}
+
+// ---------------- 双精度内核 ----------------
+
+// 不打包的行内核，K 按 kc 分块，使 B 的 kc 行留在 L2；每行一次算 32 列
+void dgemm_blocked(int m, int n, int k, const double* A, int lda, const double* B, int ldb,
+                   double* C, int ldc, int kc, int threads) {
+    #pragma omp parallel for num_threads(threads) schedule(static) if(threads > 1)
+    for (int i = 0; i < m; i++) {
+        const double* a = A + (size_t)i * lda;
+        double* c = C + (size_t)i * ldc;
+        memset(c, 0, sizeof(double) * n);
+        for (int pc = 0; pc < k; pc += kc) {
+            int pe = min_int(k, pc + kc);
+            for (int j = 0; j < n; j += 32) {
+                __mmask8 m0 = tail_mask8(n - j), m1 = tail_mask8(n - j - 8);
+                __mmask8 m2 = tail_mask8(n - j - 16), m3 = tail_mask8(n - j - 24);
+                __m512d c0 = _mm512_maskz_loadu_pd(m0, c + j), c1 = _mm512_maskz_loadu_pd(m1, c + j + 8);
+                __m512d c2 = _mm512_maskz_loadu_pd(m2, c + j + 16), c3 = _mm512_maskz_loadu_pd(m3, c + j + 24);
+                for (int p = pc; p < pe; p++) {
+                    const double* b = B + (size_t)p * ldb + j;
+                    __m512d av = _mm512_set1_pd(a[p]);
+                    c0 = _mm512_fmadd_pd(av, _mm512_maskz_loadu_pd(m0, b), c0);
+                    c1 = _mm512_fmadd_pd(av, _mm512_maskz_loadu_pd(m1, b + 8), c1);
+                    c2 = _mm512_fmadd_pd(av, _mm512_maskz_loadu_pd(m2, b + 16), c2);
+                    c3 = _mm512_fmadd_pd(av, _mm512_maskz_loadu_pd(m3, b + 24), c3);
+                }
+                _mm512_mask_storeu_pd(c + j, m0, c0);
+                _mm512_mask_storeu_pd(c + j + 8, m1, c1);
+                _mm512_mask_storeu_pd(c + j + 16, m2, c2);
+                _mm512_mask_storeu_pd(c + j + 24, m3, c3);
+            }
+        }
+    }
+}
+
+// ---------------- 执行 ----------------
+
+// 按方案执行行主序的 C = A * B
+void plan_execute(const gemm_plan* plan, dtype dt, int m, int n, int k, const void* A, int lda,
+                  const void* B, int ldb, void* C, int ldc) {
+    if (dt == DTYPE_F64) {
+        dgemm_blocked(m, n, k, (const double*)A, lda, (const double*)B, ldb, (double*)C, ldc,
+                      plan->kc, plan->threads);
+        return;
+    }
+    const float* a = (const float*)A;
+    const float* b = (const float*)B;
+    float* c = (float*)C;
+    switch (plan->kernel) {
+        case KERNEL_SMALL:
+            small_gemm(m, n, k, a, lda, b, ldb, c, ldc, plan->threads);
+            break;
+        case KERNEL_GEMV: {
+            const float* x = b;
+            if (ldb != 1) {
+                float* xc = scratch_get(SCRATCH_X, k);
+                for (int p = 0; p < k; p++) xc[p] = b[(size_t)p * ldb];
+                x = xc;
+            }
+            gemv_rows(m, k, a, lda, x, c, ldc, plan->threads);
+            break;
+        }
+        case KERNEL_PACKED:
+            packed_gemm(m, n, k, a, lda, b, ldb, c, ldc, plan->mc, plan->threads);
+            break;
+        case KERNEL_SPLIT_K:
+            split_k_gemm(m, n, k, a, lda, b, ldb, c, ldc, plan->mc, plan->threads);
+            break;
+        case KERNEL_DBLOCKED:
+            break;
+    }
+}
+
+// ---------------- 代价模型 ----------------
+
+// 在按形状新分配的随机矩阵上计时：预热一次后取 reps 次的平均
+static double time_shape(const gemm_plan* plan, dtype dt, int m, int n, int k, int reps) {
+    size_t esz = dt == DTYPE_F64 ? sizeof(double) : sizeof(float);
+    size_t na = (size_t)m * k, nb = (size_t)k * n;
+    char* A = (char*)aligned_alloc(64, esz * (na + 16));
+    char* B = (char*)aligned_alloc(64, esz * (nb + 16));
+    char* C = (char*)aligned_alloc(64, esz * ((size_t)m * n + 16));
+    if (!A || !B || !C) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < na; i++) {
+        if (dt == DTYPE_F64) ((double*)A)[i] = (double)rand() / RAND_MAX; else ((float*)A)[i] = (float)rand() / RAND_MAX;
+    }
+    for (size_t i = 0; i < nb; i++) {
+        if (dt == DTYPE_F64) ((double*)B)[i] = (double)rand() / RAND_MAX; else ((float*)B)[i] = (float)rand() / RAND_MAX;
+    }
+
+    plan_execute(plan, dt, m, n, k, A, k, B, n, C, n);
+    double t0 = now_sec();
+    for (int r = 0; r < reps; r++) plan_execute(plan, dt, m, n, k, A, k, B, n, C, n);
+    double t = (now_sec() - t0) / reps;
+    free(A);
+    free(B);
+    free(C);
+    return t;
+}
+
+// 标定：空并行区开销、各内核单线程速率与单次调用的固定开销、单线程与全部线程的读带宽
+void model_calibrate(void) {
+    dispatch_model* md = &g_model;
+    md->max_threads = min_int(omp_get_max_threads(), MAX_THREADS);
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    md->l2_bytes = l2 > 0 ? (size_t)l2 : DEFAULT_L2_BYTES;
+
+    for (int t = 1; t <= md->max_threads; t++) {
+        double t0 = now_sec();
+        for (int r = 0; r < 200; r++) {
+            #pragma omp parallel num_threads(t)
+            {
+                #pragma omp barrier
+            }
+        }
+        md->fork_cost[t] = (now_sec() - t0) / 200;
+    }
+
+    gemm_plan p = {KERNEL_SMALL, 1, 128, 256, 0.0, SOURCE_MODEL};
+    md->small_rate = 2.0 * 64 * 64 * 64 / time_shape(&p, DTYPE_F32, 64, 64, 64, 200);
+    p.kernel = KERNEL_PACKED;
+    double t1 = time_shape(&p, DTYPE_F32, 512, 512, 512, 3);
+    md->packed_rate = 2.0 * 512 * 512 * 512 / t1;
+    p.threads = md->max_threads;
+    md->cores = fmax(1.0, fmin(md->max_threads, t1 / time_shape(&p, DTYPE_F32, 512, 512, 512, 3)));
+    p.threads = 1;
+    p.kernel = KERNEL_DBLOCKED;
+    md->dbl_rate = 2.0 * 256 * 256 * 256 / time_shape(&p, DTYPE_F64, 256, 256, 256, 3);
+
+    // 固定开销：8 x 8 x 8 上的实测耗时减去按速率算出的计算时间
+    double tiny = 2.0 * 8 * 8 * 8;
+    p.kernel = KERNEL_SMALL;
+    md->call_cost[KERNEL_SMALL] = fmax(0.0, time_shape(&p, DTYPE_F32, 8, 8, 8, 10000) - tiny / md->small_rate);
+    p.kernel = KERNEL_PACKED;
+    md->call_cost[KERNEL_PACKED] = fmax(0.0, time_shape(&p, DTYPE_F32, 8, 8, 8, 10000) - tiny / md->packed_rate);
+    md->call_cost[KERNEL_SPLIT_K] = md->call_cost[KERNEL_PACKED];
+    p.kernel = KERNEL_GEMV;
+    md->call_cost[KERNEL_GEMV] = time_shape(&p, DTYPE_F32, 8, 1, 8, 10000);
+
+    // 带宽用 GEMV 标定：矩阵 64MB，远大于末级缓存
+    int gm = 4096, gk = 4096;
+    float* G = (float*)aligned_alloc(64, sizeof(float) * gm * gk);
+    float* x = (float*)aligned_alloc(64, sizeof(float) * gk);
+    float* y = (float*)aligned_alloc(64, sizeof(float) * gm);
+    if (!G || !x || !y) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < (size_t)gm * gk; i++) G[i] = 1.0f;
+    for (int p2 = 0; p2 < gk; p2++) x[p2] = 1.0f;
+    double bytes = 4.0 * gm * gk;
+    gemv_rows(gm, gk, G, gk, x, y, 1, 1);
+    double t0 = now_sec();
+    gemv_rows(gm, gk, G, gk, x, y, 1, 1);
+    md->bw1 = bytes / (now_sec() - t0);
+    t0 = now_sec();
+    gemv_rows(gm, gk, G, gk, x, y, 1, md->max_threads);
+    md->bw_max = fmax(md->bw1, bytes / (now_sec() - t0));
+    free(G);
+    free(x);
+    free(y);
+    md->calibrated = 1;
+}
+
+static inline double bandwidth(int threads) {
+    return fmin(g_model.bw1 * threads, g_model.bw_max);
+}
+
+// par 份工作真正能同时执行的份数
+static inline double parallelism(int par) {
+    return fmin(par, g_model.cores);
+}
+
+// 微内核补齐造成的浪费：边缘的 MR x NR 块按整块计算
+static inline double tile_efficiency(int m, int n) {
+    return (double)m / (ceil_div(m, MR) * MR) * (double)n / (ceil_div(n, NR) * NR);
+}
+
+// 预测方案在行主序 m x n x k 上的耗时 (秒)
+double plan_estimate(const gemm_plan* p, dtype dt, int m, int n, int k) {
+    const dispatch_model* md = &g_model;
+    double flops = 2.0 * m * n * k;
+    int t = p->threads;
+    double time = (t > 1 ? md->fork_cost[t] : 0.0) + md->call_cost[p->kernel];
+
+    if (dt == DTYPE_F64) {
+        int par = min_int(t, m);
+        return time + flops / (md->dbl_rate * parallelism(par));
+    }
+
+    switch (p->kernel) {
+        case KERNEL_SMALL: {
+            int par = min_int(t, m);
+            double lanes = (double)n / (ceil_div(n, SMALL_NB) * SMALL_NB);
+            time += flops / (md->small_rate * lanes * parallelism(par));
+            // B 放不进 L2 时每一行 A 都要把 B 从外层缓存或内存重读一遍
+            if (4.0 * k * n > md->l2_bytes) time += 4.0 * m * k * n / bandwidth(par);
+            break;
+        }
+        case KERNEL_GEMV: {
+            int par = min_int(t, m);
+            time += 4.0 * ((double)m * k + k + m) / bandwidth(par);
+            break;
+        }
+        case KERNEL_PACKED: {
+            int par = min_int(t, ceil_div(m, p->mc));
+            time += flops / (md->packed_rate * tile_efficiency(m, n) * parallelism(par));
+            // 打包 A、B 各读写一遍；每个行块都要把共享的 B 面板读一遍，mc 越小读得越多
+            double pack = 8.0 * ((double)m * k * ceil_div(n, NC_BLOCK) + (double)k * n);
+            double panel = 4.0 * ceil_div(m, p->mc) * (double)k * n;
+            time += pack / bandwidth(t) + panel / bandwidth(par) / parallelism(par);
+            break;
+        }
+        case KERNEL_SPLIT_K: {
+            int par = min_int(t, ceil_div(k, KC_BLOCK));
+            time += flops / (md->packed_rate * tile_efficiency(m, n) * parallelism(par));
+            double pack = 8.0 * ((double)m * k * ceil_div(n, NC_BLOCK) + (double)k * n);
+            double panel = 4.0 * ceil_div(m, p->mc) * (double)k * n;
+            double reduce = 8.0 * (par - 1) * (double)m * n;
+            time += (pack + panel) / bandwidth(par) / parallelism(par) + reduce / bandwidth(t);
+            break;
+        }
+        case KERNEL_DBLOCKED:
+            break;
+    }
+    return time;
+}
+
+// 双精度内核的 kc：B 的 kc 行 (n 列) 占 L2 的一半以内，至少 64
+static int dbl_kc(int n) {
+    int kc = (int)(g_model.l2_bytes / 2 / (sizeof(double) * max_int(n, 1)));
+    kc = kc / 64 * 64;
+    return max_int(64, min_int(kc, 1024));
+}
+
+// 枚举候选方案并按模型预测的耗时排序，返回候选个数
+static int plan_candidates(dtype dt, int m, int n, int k, gemm_plan* out, int cap) {
+    static const int mcs[] = { 32, 64, 128, MAX_MC };
+    int threads[32], nthreads = 0;
+    for (int t = 1; t < g_model.max_threads; t *= 2) threads[nthreads++] = t;
+    threads[nthreads++] = g_model.max_threads;
+
+    int count = 0;
+    for (int ti = 0; ti < nthreads; ti++) {
+        int t = threads[ti];
+        gemm_plan p = {KERNEL_SMALL, t, 128, KC_BLOCK, 0.0, SOURCE_MODEL};
+        if (dt == DTYPE_F64) {
+            p.kernel = KERNEL_DBLOCKED;
+            p.kc = dbl_kc(n);
+            if (count < cap) out[count++] = p;
+            continue;
+        }
+        if (n == 1 && count < cap) {
+            p.kernel = KERNEL_GEMV;
+            out[count++] = p;
+        }
+        p.kernel = KERNEL_SMALL;
+        if (count < cap) out[count++] = p;
+        p.kernel = KERNEL_PACKED;
+        for (size_t i = 0; i < sizeof(mcs) / sizeof(mcs[0]); i++) {
+            p.mc = mcs[i];
+            if (count < cap) out[count++] = p;
+        }
+        if (t > 1 && t <= ceil_div(k, KC_BLOCK) && count < cap) {
+            p.kernel = KERNEL_SPLIT_K;
+            p.mc = 128;
+            out[count++] = p;
+        }
+    }
+
+    for (int i = 0; i < count; i++) out[i].predicted = plan_estimate(&out[i], dt, m, n, k);
+    // 候选不多，插入排序即可
+    for (int i = 1; i < count; i++) {
+        gemm_plan p = out[i];
+        int j = i - 1;
+        while (j >= 0 && out[j].predicted > p.predicted) {
+            out[j + 1] = out[j];
+            j--;
+        }
+        out[j + 1] = p;
+    }
+    return count;
+}
+
+// ---------------- 决策缓存 ----------------
+
+static inline uint32_t shape_hash(int m, int n, int k, dtype dt, layout lo) {
+    uint64_t h = (uint64_t)m * 0x9E3779B97F4A7C15ull;
+    h ^= (uint64_t)n * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+    h ^= (uint64_t)k * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+    h ^= (uint64_t)(dt * 2 + lo) * 0x27D4EB2F165667C5ull;
+    h ^= h >> 29;
+    return (uint32_t)h;
+}
+
+static inline uint32_t cache_home(const cache_entry* e) {
+    return shape_hash(e->m, e->n, e->k, e->dt, e->lo) & (CACHE_SLOTS - 1);
+}
+
+// 淘汰最久未使用的一项，后面同一探测链上的项往前挪，保证线性探测查找不断链
+// 只在未命中且表已到 3/4 时发生，全表扫描的代价远小于一次规划
+static void cache_evict(void) {
+    uint32_t hole = 0;
+    for (uint32_t i = 1; i < CACHE_SLOTS; i++) {
+        if (g_cache[i].used && (!g_cache[hole].used || g_cache[i].last_use < g_cache[hole].last_use)) hole = i;
+    }
+    g_cache[hole].used = 0;
+    g_cache_count--;
+    for (uint32_t i = (hole + 1) & (CACHE_SLOTS - 1); g_cache[i].used; i = (i + 1) & (CACHE_SLOTS - 1)) {
+        // home 落在 (hole, i] 之间的项留在原处，否则挪进空位
+        uint32_t home = cache_home(&g_cache[i]);
+        if (((i - home) & (CACHE_SLOTS - 1)) < ((i - hole) & (CACHE_SLOTS - 1))) continue;
+        g_cache[hole] = g_cache[i];
+        g_cache[i].used = 0;
+        hole = i;
+    }
+}
+
+// 查找形状对应的槽；insert 为真时找不到就占一个空槽，表满 3/4 时先淘汰一项
+static cache_entry* cache_lookup(int m, int n, int k, dtype dt, layout lo, int insert) {
+    uint32_t i = shape_hash(m, n, k, dt, lo) & (CACHE_SLOTS - 1);
+    while (g_cache[i].used) {
+        cache_entry* e = &g_cache[i];
+        if (e->m == m && e->n == n && e->k == k && e->dt == dt && e->lo == lo) {
+            e->last_use = ++g_cache_tick;
+            return e;
+        }
+        i = (i + 1) & (CACHE_SLOTS - 1);
+    }
+    if (!insert) return NULL;
+    if (g_cache_count >= CACHE_SLOTS * 3 / 4) {
+        cache_evict();
+        return cache_lookup(m, n, k, dt, lo, 1);
+    }
+    g_cache[i].used = 1;
+    g_cache[i].last_use = ++g_cache_tick;
+    g_cache[i].m = m;
+    g_cache[i].n = n;
+    g_cache[i].k = k;
+    g_cache[i].dt = dt;
+    g_cache[i].lo = lo;
+    g_cache_count++;
+    return &g_cache[i];
+}
+
+// 列主序的 C = A * B 等价于行主序的 C^T = B^T * A^T，规划和执行都在这个等价问题上进行
+static inline void to_row_major(layout lo, int* m, int* n) {
+    if (lo == LAYOUT_COL_MAJOR) {
+        int t = *m;
+        *m = *n;
+        *n = t;
+    }
+}
+
+// 取得形状对应的方案：命中缓存直接返回，否则由代价模型决定并写入缓存
+// 按值返回，之后的插入或淘汰不会影响调用者手里的方案
+gemm_plan dispatch_plan(layout lo, dtype dt, int m, int n, int k) {
+    cache_entry* e = cache_lookup(m, n, k, dt, lo, 0);
+    if (e) {
+        g_cache_hits++;
+        return e->plan;
+    }
+    g_cache_misses++;
+    if (!g_model.calibrated) model_calibrate();
+
+    gemm_plan cands[128];
+    int rm = m, rn = n;
+    to_row_major(lo, &rm, &rn);
+    plan_candidates(dt, rm, rn, k, cands, 128);
+    e = cache_lookup(m, n, k, dt, lo, 1);
+    e->plan = cands[0];
+    return e->plan;
+}
+
+// 实测调优：在随机数据上实测模型排名前几位的候选，把最快的写入缓存
+gemm_plan dispatch_tune(layout lo, dtype dt, int m, int n, int k) {
+    if (!g_model.calibrated) model_calibrate();
+    int rm = m, rn = n;
+    to_row_major(lo, &rm, &rn);
+
+    gemm_plan cands[128];
+    int count = min_int(plan_candidates(dt, rm, rn, k, cands, 128), TUNE_CANDIDATES);
+    int reps = max_int(1, (int)fmin(1000.0, 2e7 / (2.0 * rm * rn * k)));
+    int best = 0;
+    double best_time = 1e30;
+    for (int i = 0; i < count; i++) {
+        double t = time_shape(&cands[i], dt, rm, rn, k, reps);
+        if (t < best_time) {
+            best_time = t;
+            best = i;
+        }
+    }
+    cache_entry* e = cache_lookup(m, n, k, dt, lo, 1);
+    e->plan = cands[best];
+    e->plan.source = SOURCE_MEASURED;
+    return e->plan;
+}
+
+// 调度入口：C = A * B，lo 指定三个矩阵的存储顺序，dt 指定元素类型
+int gemm_dispatch(layout lo, dtype dt, int m, int n, int k, const void* A, int lda,
+                  const void* B, int ldb, void* C, int ldc) {
+    if (m <= 0 || n <= 0 || k <= 0) return -1;
+    gemm_plan plan = dispatch_plan(lo, dt, m, n, k);
+    if (lo == LAYOUT_COL_MAJOR) {
+        plan_execute(&plan, dt, n, m, k, B, ldb, A, lda, C, ldc);
+    } else {
+        plan_execute(&plan, dt, m, n, k, A, lda, B, ldb, C, ldc);
+    }
+    return 0;
+}
+
+// ---------------- 基准测试 ----------------
+
+typedef struct {
+    int m, n, k;
+    dtype dt;
+    layout lo;
+} shape;
+
+static inline double elem(const void* M, int ld, layout lo, dtype dt, int r, int c) {
+    size_t off = lo == LAYOUT_ROW_MAJOR ? (size_t)r * ld + c : (size_t)c * ld + r;
+    return dt == DTYPE_F64 ? ((const double*)M)[off] : ((const float*)M)[off];
+}
+
+double check_result(const shape* s, const void* A, int lda, const void* B, int ldb, const void* C, int ldc) {
+    double max_err = 0.0;
+    for (int t = 0; t < 64; t++) {
+        int i = rand() % s->m;
+        int j = rand() % s->n;
+        double ref = 0.0, scale = 0.0;
+        for (int p = 0; p < s->k; p++) {
+            double v = elem(A, lda, s->lo, s->dt, i, p) * elem(B, ldb, s->lo, s->dt, p, j);
+            ref += v;
+            scale += fabs(v);
+        }
+        double err = fabs(elem(C, ldc, s->lo, s->dt, i, j) - ref) / (scale + 1e-30);
+        if (err > max_err) max_err = err;
+    }
+    return max_err;
+}
+
+// 反复调用直到累计约 0.2 秒，返回单次平均耗时
+static double time_calls(const gemm_plan* fixed, const shape* s, const void* A, int lda,
+                         const void* B, int ldb, void* C, int ldc) {
+    int rm = s->m, rn = s->n;
+    to_row_major(s->lo, &rm, &rn);
+    int reps = 0;
+    double t0 = now_sec(), elapsed;
+    do {
+        if (fixed && s->lo == LAYOUT_COL_MAJOR) {
+            plan_execute(fixed, s->dt, rm, rn, s->k, B, ldb, A, lda, C, ldc);
+        } else if (fixed) {
+            plan_execute(fixed, s->dt, rm, rn, s->k, A, lda, B, ldb, C, ldc);
+        } else {
+            gemm_dispatch(s->lo, s->dt, s->m, s->n, s->k, A, lda, B, ldb, C, ldc);
+        }
+        reps++;
+        elapsed = now_sec() - t0;
+    } while (elapsed < 0.2 || reps < 3);
+    return elapsed / reps;
+}
+
+void bench_shape(const shape* s, int tune) {
+    size_t esz = s->dt == DTYPE_F64 ? sizeof(double) : sizeof(float);
+    int row = s->lo == LAYOUT_ROW_MAJOR;
+    int lda = row ? s->k : s->m, ldb = row ? s->n : s->k, ldc = row ? s->n : s->m;
+    size_t na = (size_t)s->m * s->k, nb = (size_t)s->k * s->n, nc = (size_t)s->m * s->n;
+    void* A = aligned_alloc(64, esz * (na + 16));
+    void* B = aligned_alloc(64, esz * (nb + 16));
+    void* C = aligned_alloc(64, esz * (nc + 16));
+    if (!A || !B || !C) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < na; i++) {
+        double v = (double)rand() / RAND_MAX;
+        if (s->dt == DTYPE_F64) ((double*)A)[i] = v; else ((float*)A)[i] = (float)v;
+    }
+    for (size_t i = 0; i < nb; i++) {
+        double v = (double)rand() / RAND_MAX;
+        if (s->dt == DTYPE_F64) ((double*)B)[i] = v; else ((float*)B)[i] = (float)v;
+    }
+
+    // 固定配置：与 v9 一样总是用全部线程，单精度走打包内核
+    gemm_plan fixed = {KERNEL_PACKED, g_model.max_threads, 128, KC_BLOCK, 0.0, SOURCE_FIXED};
+    if (s->dt == DTYPE_F64) {
+        fixed.kernel = KERNEL_DBLOCKED;
+        fixed.kc = KC_BLOCK;
+    }
+    double t_fixed = time_calls(&fixed, s, A, lda, B, ldb, C, ldc);
+
+    gemm_plan plan = tune ? dispatch_tune(s->lo, s->dt, s->m, s->n, s->k)
+                          : dispatch_plan(s->lo, s->dt, s->m, s->n, s->k);
+    double t_disp = time_calls(NULL, s, A, lda, B, ldb, C, ldc);
+    double err = check_result(s, A, lda, B, ldb, C, ldc);
+
+    char shape_str[64], plan_str[64];
+    snprintf(shape_str, sizeof(shape_str), "%dx%dx%d %s %s", s->m, s->n, s->k,
+             s->dt == DTYPE_F64 ? "f64" : "f32", row ? "行" : "列");
+    if (plan.kernel == KERNEL_PACKED || plan.kernel == KERNEL_SPLIT_K) {
+        snprintf(plan_str, sizeof(plan_str), "%s t=%d mc=%d (%s)", kernel_name(plan.kernel),
+                 plan.threads, plan.mc, source_name(plan.source));
+    } else if (plan.kernel == KERNEL_DBLOCKED) {
+        snprintf(plan_str, sizeof(plan_str), "%s t=%d kc=%d (%s)", kernel_name(plan.kernel),
+                 plan.threads, plan.kc, source_name(plan.source));
+    } else {
+        snprintf(plan_str, sizeof(plan_str), "%s t=%d (%s)", kernel_name(plan.kernel),
+                 plan.threads, source_name(plan.source));
+    }
+    double flops = 2.0 * s->m * s->n * s->k;
+    printf("  %-26s %-28s 固定: %8.2f GFLOPS  调度: %8.2f GFLOPS  加速比: %5.2f  误差: %.1e\n",
+           shape_str, plan_str, flops / t_fixed / 1e9, flops / t_disp / 1e9, t_fixed / t_disp, err);
+
+    free(A);
+    free(B);
+    free(C);
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    int tune = argc > 1 && strcmp(argv[1], "tune") == 0;
+
+    double t0 = now_sec();
+    model_calibrate();
+    printf("线程数: %d  标定耗时: %.3f 秒  L2: %zu KB\n", g_model.max_threads, now_sec() - t0,
+           g_model.l2_bytes >> 10);
+    printf("单线程速率: 小矩阵 %.1f / 打包 %.1f / 双精度 %.1f GFLOPS  全部线程加速比: %.2f\n",
+           g_model.small_rate / 1e9, g_model.packed_rate / 1e9, g_model.dbl_rate / 1e9, g_model.cores);
+    printf("带宽: 单线程 %.1f / 全部 %.1f GB/s  并行区开销: %.2f 微秒\n",
+           g_model.bw1 / 1e9, g_model.bw_max / 1e9, g_model.fork_cost[g_model.max_threads] * 1e6);
+    printf("方案来源: %s\n", tune ? "实测调优" : "代价模型");
+
+    static const shape shapes[] = {
+        {8, 8, 8, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {24, 24, 24, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {64, 64, 64, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {128, 128, 128, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {256, 256, 256, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {512, 512, 512, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {1024, 1024, 1024, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {2048, 2048, 2048, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {4096, 1, 4096, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {16, 16, 65536, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {64, 4096, 64, DTYPE_F32, LAYOUT_ROW_MAJOR},
+        {1000, 600, 300, DTYPE_F32, LAYOUT_COL_MAJOR},
+        {256, 256, 256, DTYPE_F64, LAYOUT_ROW_MAJOR},
+        {1024, 1024, 1024, DTYPE_F64, LAYOUT_ROW_MAJOR},
+    };
+    int count = sizeof(shapes) / sizeof(shapes[0]);
+    for (int i = 0; i < count; i++) bench_shape(&shapes[i], tune);
+
+    // 规划开销：清空缓存后首次规划与命中缓存分别计时
+    memset(g_cache, 0, sizeof(g_cache));
+    g_cache_count = 0;
+    t0 = now_sec();
+    for (int i = 0; i < count; i++) dispatch_plan(shapes[i].lo, shapes[i].dt, shapes[i].m, shapes[i].n, shapes[i].k);
+    double t_miss = (now_sec() - t0) / count;
+    int lookups = 1000000;
+    t0 = now_sec();
+    for (int r = 0; r < lookups; r++) {
+        const shape* s = &shapes[r % count];
+        dispatch_plan(s->lo, s->dt, s->m, s->n, s->k);
+    }
+    double t_hit = (now_sec() - t0) / lookups;
+    printf("规划开销: 首次 %.2f 微秒  命中缓存 %.1f 纳秒  (命中 %ld 次, 未命中 %ld 次)\n",
+           t_miss * 1e6, t_hit * 1e9, g_cache_hits, g_cache_misses);
+    return 0;
+}
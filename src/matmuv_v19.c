@@ -0,0 +1,500 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <omp.h>
+#include <immintrin.h>
+
+// 打包内核的寄存器分块与缓存分块 (同 v16 实数部分)
+#define MR 8
+#define NR 32
+#define MC_BLOCK 128
+#define KC_BLOCK 256
+#define NC_BLOCK 2048
+// 预取距离以 k 步计：一步消耗 A 半条缓存行、B 两条缓存行
+// 距离必须是偶数 (内核按两步展开，每两步发一次 A 的预取)，且不超过 KC_BLOCK
+#define MAX_PF_DIST KC_BLOCK
+// 自动选择距离时尝试的候选与标定形状
+#define TUNE_SIZE 1024
+#define TUNE_REPS 3
+
+// 预取配置：A / B 两条流在微内核里按距离提前取，越过当前微面板末尾时取下一次调用要用的微面板；
+// C 流在进入微内核时把本次要写回的 C 块取进 L1。level 为 1 时 A / B 取到 L1 (T0)，为 2 时取到 L2 (T1)
+typedef struct {
+    int a_dist;
+    int b_dist;
+    int c_tile;
+    int level;
+} prefetch_config;
+
+// 硬件计数器：每个事件单独打开，inherit 让之后创建的 OpenMP 线程也计入
+#define NUM_COUNTERS 5
+typedef struct {
+    int fd[NUM_COUNTERS];
+    long long value[NUM_COUNTERS];
+} perf_counters;
+
+static const char* counter_names[NUM_COUNTERS] = { "周期", "指令", "L1D 读缺失", "末级缓存缺失", "L1D 预取" };
+
+static inline int min_int(int a, int b) { return a < b ? a : b; }
+
+static inline __mmask16 tail_mask(int n) {
+    if (n >= 16) return 0xFFFF;
+    if (n <= 0) return 0;
+    return (__mmask16)((1u << n) - 1);
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// _mm_prefetch 的提示必须是常量，按级别分两支；level 在循环外不变，分支可以预测
+static inline __attribute__((always_inline)) void prefetch_to(const void* p, int level) {
+    if (level == 1) {
+        _mm_prefetch((const char*)p, _MM_HINT_T0);
+    } else {
+        _mm_prefetch((const char*)p, _MM_HINT_T1);
+    }
+}
+
+// ---------------- 预取配置 ----------------
+
+// 把距离截到 [0, MAX_PF_DIST] 的偶数，越界时给出警告
+static int validate_dist(const char* name, int dist) {
+    int fixed = dist;
+    if (fixed < 0) fixed = 0;
+    if (fixed > MAX_PF_DIST) fixed = MAX_PF_DIST;
+    fixed &= ~1;
+    if (fixed != dist) {
+        fprintf(stderr, "警告: %s 预取距离 %d 无效 (应为 0 到 %d 之间的偶数)，已改为 %d\n",
+                name, dist, MAX_PF_DIST, fixed);
+    }
+    return fixed;
+}
+
+void prefetch_validate(prefetch_config* pf) {
+    pf->a_dist = validate_dist("A", pf->a_dist);
+    pf->b_dist = validate_dist("B", pf->b_dist);
+    pf->c_tile = pf->c_tile != 0;
+    if (pf->level != 1 && pf->level != 2) {
+        fprintf(stderr, "警告: 预取级别 %d 无效 (应为 1 或 2)，已改为 1\n", pf->level);
+        pf->level = 1;
+    }
+}
+
+static void format_config(const prefetch_config* pf, char* buf, size_t size) {
+    snprintf(buf, size, "A=%d B=%d C=%s L%d", pf->a_dist, pf->b_dist, pf->c_tile ? "开" : "关", pf->level);
+}
+
+// ---------------- 打包与微内核 ----------------
+
+void pack_a(int mc, int kc, const float* A, int lda, float* pa) {
+    for (int i = 0; i < mc; i += MR) {
+        int mr = min_int(MR, mc - i);
+        for (int k = 0; k < kc; k++) {
+            for (int r = 0; r < mr; r++) pa[r] = A[(size_t)(i + r) * lda + k];
+            for (int r = mr; r < MR; r++) pa[r] = 0.0f;
+            pa += MR;
+        }
+    }
+}
+
+void pack_b_panel(int kc, int nr, const float* B, int ldb, float* pb) {
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int k = 0; k < kc; k++) {
+        const float* b = B + (size_t)k * ldb;
+        _mm512_store_ps(pb, _mm512_maskz_loadu_ps(m0, b));
+        _mm512_store_ps(pb + 16, _mm512_maskz_loadu_ps(m1, b + 16));
+        pb += NR;
+    }
+}
+
+// 一个 k 步：C[MR x 32] += pa[k] * pb[k]
+#define KERNEL_STEP(pa, pb)                                          \
+    do {                                                             \
+        __m512 b0 = _mm512_load_ps(pb);                              \
+        __m512 b1 = _mm512_load_ps((pb) + 16);                       \
+        for (int r = 0; r < MR; r++) {                               \
+            __m512 a = _mm512_set1_ps((pa)[r]);                      \
+            c0[r] = _mm512_fmadd_ps(a, b0, c0[r]);                   \
+            c1[r] = _mm512_fmadd_ps(a, b1, c1[r]);                   \
+        }                                                            \
+    } while (0)
+
+// 微内核：C[mr x nr] += pa * pb
+// next_a / next_b 是下一次调用要用的微面板，预取地址越过当前微面板末尾后转到它们上面
+void micro_kernel(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr,
+                  const float* next_a, const float* next_b, const prefetch_config* pf) {
+    __m512 c0[MR], c1[MR];
+    for (int r = 0; r < MR; r++) {
+        c0[r] = _mm512_setzero_ps();
+        c1[r] = _mm512_setzero_ps();
+    }
+
+    // C 块要到 kc 步之后才读，现在取进来正好赶上
+    if (pf->c_tile) {
+        for (int r = 0; r < mr; r++) {
+            const float* c = C + (size_t)r * ldc;
+            _mm_prefetch((const char*)c, _MM_HINT_T0);
+            _mm_prefetch((const char*)(c + nr - 1), _MM_HINT_T0);
+        }
+    }
+
+    int da = pf->a_dist, db = pf->b_dist, level = pf->level;
+    int k = 0;
+    for (; k + 2 <= kc; k += 2) {
+        if (da) {
+            int t = k + da;
+            const float* p = t < kc ? pa + t * MR : next_a + (t - kc) * MR;
+            prefetch_to(p, level);
+        }
+        if (db) {
+            int t = k + db;
+            const float* p = t < kc ? pb + t * NR : next_b + (t - kc) * NR;
+            prefetch_to(p, level);
+            prefetch_to(p + 16, level);
+            prefetch_to(p + NR, level);
+            prefetch_to(p + NR + 16, level);
+        }
+        KERNEL_STEP(pa + k * MR, pb + k * NR);
+        KERNEL_STEP(pa + (k + 1) * MR, pb + (k + 1) * NR);
+    }
+    if (k < kc) KERNEL_STEP(pa + k * MR, pb + k * NR);
+
+    __mmask16 m0 = tail_mask(nr);
+    __mmask16 m1 = tail_mask(nr - 16);
+    for (int r = 0; r < mr; r++) {
+        float* c = C + (size_t)r * ldc;
+        _mm512_mask_storeu_ps(c, m0, _mm512_add_ps(c0[r], _mm512_maskz_loadu_ps(m0, c)));
+        _mm512_mask_storeu_ps(c + 16, m1, _mm512_add_ps(c1[r], _mm512_maskz_loadu_ps(m1, c + 16)));
+    }
+}
+
+// C = A * B：与 v9 一样按 L2 行块并行，B 面板由全体线程共同打包一次后共享
+// 微内核的遍历顺序是 jr 外 ir 内：同一 B 微面板连续用 mc / MR 次，之后才换下一个 B 微面板，
+// 所以 A 的“下一个”是同一面板序列里的下一个 (最后一个之后回到开头)，B 的“下一个”在最后一个 ir 上才换
+int sgemm(int m, int n, int k, const float* A, int lda, const float* B, int ldb, float* C, int ldc,
+          const prefetch_config* pf) {
+    float* pb = (float*)aligned_alloc(64, sizeof(float) * KC_BLOCK * NC_BLOCK);
+    if (!pb) return -1;
+    int failed = 0;
+
+    #pragma omp parallel
+    {
+        float* pa = (float*)aligned_alloc(64, sizeof(float) * MC_BLOCK * KC_BLOCK);
+        if (!pa) {
+            #pragma omp atomic write
+            failed = 1;
+        }
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < m; i++) memset(C + (size_t)i * ldc, 0, sizeof(float) * n);
+
+        for (int jc = 0; jc < n; jc += NC_BLOCK) {
+            int nc = min_int(NC_BLOCK, n - jc);
+            for (int pc = 0; pc < k; pc += KC_BLOCK) {
+                int kc = min_int(KC_BLOCK, k - pc);
+                #pragma omp for schedule(static)
+                for (int jr = 0; jr < nc; jr += NR) {
+                    pack_b_panel(kc, min_int(NR, nc - jr), B + (size_t)pc * ldb + jc + jr, ldb, pb + jr * kc);
+                }
+                #pragma omp for schedule(dynamic)
+                for (int ic = 0; ic < m; ic += MC_BLOCK) {
+                    if (!pa) continue;
+                    int mc = min_int(MC_BLOCK, m - ic);
+                    pack_a(mc, kc, A + (size_t)ic * lda + pc, lda, pa);
+                    for (int jr = 0; jr < nc; jr += NR) {
+                        const float* pbj = pb + jr * kc;
+                        for (int ir = 0; ir < mc; ir += MR) {
+                            int last = ir + MR >= mc;
+                            const float* next_a = last ? pa : pa + (ir + MR) * kc;
+                            const float* next_b = last ? pbj + NR * kc : pbj;
+                            micro_kernel(kc, pa + ir * kc, pbj, C + (size_t)(ic + ir) * ldc + jc + jr, ldc,
+                                         min_int(MR, mc - ir), min_int(NR, nc - jr), next_a, next_b, pf);
+                        }
+                    }
+                }
+            }
+        }
+        free(pa);
+    }
+    free(pb);
+    return failed ? -1 : 0;
+}
+
+// ---------------- 硬件计数器 ----------------
+
+static int perf_open(unsigned type, unsigned long long config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// 必须在第一个 OpenMP 并行区之前调用，否则线程池里的线程不会继承计数器
+void counters_open(perf_counters* pc) {
+    unsigned long long l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    unsigned long long l1d_prefetch = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_PREFETCH << 8) |
+                                      (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16);
+    pc->fd[0] = perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    pc->fd[1] = perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    pc->fd[2] = perf_open(PERF_TYPE_HW_CACHE, l1d_read_miss);
+    pc->fd[3] = perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    pc->fd[4] = perf_open(PERF_TYPE_HW_CACHE, l1d_prefetch);
+}
+
+void counters_start(perf_counters* pc) {
+    for (int i = 0; i < NUM_COUNTERS; i++) {
+        if (pc->fd[i] < 0) continue;
+        ioctl(pc->fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+// 读不到的计数器记为 -1
+void counters_stop(perf_counters* pc) {
+    for (int i = 0; i < NUM_COUNTERS; i++) {
+        pc->value[i] = -1;
+        if (pc->fd[i] < 0) continue;
+        ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        long long v;
+        if (read(pc->fd[i], &v, sizeof(v)) == sizeof(v)) pc->value[i] = v;
+    }
+}
+
+void counters_close(perf_counters* pc) {
+    for (int i = 0; i < NUM_COUNTERS; i++) {
+        if (pc->fd[i] >= 0) close(pc->fd[i]);
+    }
+}
+
+// ---------------- 运行时选择距离 ----------------
+
+// 从环境变量读取配置：MATMUV_PF_A / MATMUV_PF_B (距离)、MATMUV_PF_C (0 或 1)、MATMUV_PF_LEVEL (1 或 2)
+// 返回读到的变量个数
+int prefetch_from_env(prefetch_config* pf) {
+    const char* names[4] = { "MATMUV_PF_A", "MATMUV_PF_B", "MATMUV_PF_C", "MATMUV_PF_LEVEL" };
+    int* fields[4] = { &pf->a_dist, &pf->b_dist, &pf->c_tile, &pf->level };
+    int found = 0;
+    for (int i = 0; i < 4; i++) {
+        const char* v = getenv(names[i]);
+        if (!v) continue;
+        char* end;
+        long x = strtol(v, &end, 10);
+        if (end == v || *end != '\0') {
+            fprintf(stderr, "警告: 环境变量 %s=%s 不是整数，已忽略\n", names[i], v);
+            continue;
+        }
+        *fields[i] = (int)x;
+        found++;
+    }
+    prefetch_validate(pf);
+    return found;
+}
+
+static double time_sgemm(int m, int n, int k, const float* A, const float* B, float* C,
+                         const prefetch_config* pf, int reps) {
+    double best = 1e30;
+    for (int r = 0; r < reps; r++) {
+        double t0 = now_sec();
+        sgemm(m, n, k, A, k, B, n, C, n, pf);
+        double t = now_sec() - t0;
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+// 在 TUNE_SIZE 的方阵上先选 A 的距离，再在它的基础上选 B 的距离，各取最快的一个
+prefetch_config prefetch_autotune(void) {
+    static const int dists[] = { 0, 4, 8, 16, 32, 64 };
+    int count = sizeof(dists) / sizeof(dists[0]);
+    int s = TUNE_SIZE;
+    float* A = (float*)aligned_alloc(64, sizeof(float) * s * s);
+    float* B = (float*)aligned_alloc(64, sizeof(float) * s * s);
+    float* C = (float*)aligned_alloc(64, sizeof(float) * s * s);
+    if (!A || !B || !C) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < s * s; i++) {
+        A[i] = (float)rand() / RAND_MAX;
+        B[i] = (float)rand() / RAND_MAX;
+    }
+
+    prefetch_config pf = {0, 0, 1, 1};
+    double best = 1e30;
+    int best_a = 0, best_b = 0;
+    for (int i = 0; i < count; i++) {
+        pf.a_dist = dists[i];
+        double t = time_sgemm(s, s, s, A, B, C, &pf, TUNE_REPS);
+        if (t < best) {
+            best = t;
+            best_a = dists[i];
+        }
+    }
+    pf.a_dist = best_a;
+    for (int i = 0; i < count; i++) {
+        pf.b_dist = dists[i];
+        double t = time_sgemm(s, s, s, A, B, C, &pf, TUNE_REPS);
+        if (t < best) {
+            best = t;
+            best_b = dists[i];
+        }
+    }
+    pf.b_dist = best_b;
+
+    free(A);
+    free(B);
+    free(C);
+    return pf;
+}
+
+// ---------------- 基准测试 ----------------
+
+void init_matrix(float* M, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        M[i] = (float)rand() / RAND_MAX * 10.0f;
+    }
+}
+
+double check_result(int m, int n, int k, const float* A, const float* B, const float* C) {
+    double max_err = 0.0;
+    for (int s = 0; s < 64; s++) {
+        int i = rand() % m;
+        int j = rand() % n;
+        double ref = 0.0;
+        for (int p = 0; p < k; p++) ref += (double)A[(size_t)i * k + p] * B[(size_t)p * n + j];
+        double err = fabs(C[(size_t)i * n + j] - ref) / (fabs(ref) + 1e-30);
+        if (err > max_err) max_err = err;
+    }
+    return max_err;
+}
+
+static void print_counter(long long v, long long base) {
+    if (v < 0) {
+        printf(" %14s", "不可用");
+    } else if (base > 0) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.3e(%+.0f%%)", (double)v, 100.0 * (v - base) / base);
+        printf(" %14s", buf);
+    } else {
+        printf(" %14.3e", (double)v);
+    }
+}
+
+// 消融：以不预取为基准，逐条打开 A / B / C 流，再看全开与取到 L2 的效果
+// 选定配置关掉的流在消融里用 ABLATION_DIST 测试，参数列中以 * 标出；最后一行是选定配置本身，source 为其来源
+#define ABLATION_DIST 16
+
+void ablation(int m, int n, int k, const prefetch_config* tuned, const char* source, perf_counters* pc) {
+    float* A = (float*)aligned_alloc(64, sizeof(float) * ((size_t)m * k + 16));
+    float* B = (float*)aligned_alloc(64, sizeof(float) * ((size_t)k * n + 16));
+    float* C = (float*)aligned_alloc(64, sizeof(float) * ((size_t)m * n + 16));
+    if (!A || !B || !C) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(EXIT_FAILURE);
+    }
+    init_matrix(A, (size_t)m * k);
+    init_matrix(B, (size_t)k * n);
+
+    int da = tuned->a_dist ? tuned->a_dist : ABLATION_DIST;
+    int db = tuned->b_dist ? tuned->b_dist : ABLATION_DIST;
+    struct {
+        const char* name;
+        prefetch_config pf;
+    } cases[] = {
+        { "不预取",        { 0, 0, 0, 1 } },
+        { "仅 A",          { da, 0, 0, 1 } },
+        { "仅 B",          { 0, db, 0, 1 } },
+        { "仅 C",          { 0, 0, 1, 1 } },
+        { "A + B",         { da, db, 0, 1 } },
+        { "全部 (L1)",     { da, db, 1, 1 } },
+        { "全部 (L2)",     { da, db, 1, 2 } },
+        { source,          *tuned },
+    };
+    int count = sizeof(cases) / sizeof(cases[0]);
+
+    printf("消融 (M=%d N=%d K=%d，计数器为单次调用):\n", m, n, k);
+    printf("  %-12s %-22s %10s %8s", "配置", "参数", "GFLOPS", "增益");
+    for (int i = 0; i < NUM_COUNTERS; i++) printf(" %14s", counter_names[i]);
+    printf("\n");
+
+    double flops = 2.0 * m * n * k;
+    double base_time = 0.0;
+    long long base[NUM_COUNTERS];
+    int substituted = 0;
+    for (int c = 0; c < count; c++) {
+        double t = time_sgemm(m, n, k, A, B, C, &cases[c].pf, 3);
+        counters_start(pc);
+        sgemm(m, n, k, A, k, B, n, C, n, &cases[c].pf);
+        counters_stop(pc);
+        if (c == 0) {
+            base_time = t;
+            memcpy(base, pc->value, sizeof(base));
+        }
+
+        // 选定配置关闭、这里用替代距离测试的流加 * 标出
+        const prefetch_config* pf = &cases[c].pf;
+        int mark_a = pf->a_dist && !tuned->a_dist, mark_b = pf->b_dist && !tuned->b_dist;
+        substituted |= mark_a | mark_b;
+        char params[64];
+        snprintf(params, sizeof(params), "A=%d%s B=%d%s C=%s L%d", pf->a_dist, mark_a ? "*" : "",
+                 pf->b_dist, mark_b ? "*" : "", pf->c_tile ? "开" : "关", pf->level);
+        printf("  %-12s %-22s %10.2f %+7.1f%%", cases[c].name, params, flops / t / 1e9,
+               100.0 * (base_time / t - 1.0));
+        for (int i = 0; i < NUM_COUNTERS; i++) print_counter(pc->value[i], c == 0 ? 0 : base[i]);
+        printf("\n");
+    }
+    if (substituted) printf("  * %s配置关闭了该预取流，消融中以距离 %d 代替\n", source, ABLATION_DIST);
+    printf("  最大相对误差: %.2e\n", check_result(m, n, k, A, B, C));
+
+    free(A);
+    free(B);
+    free(C);
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    perf_counters pc;
+    counters_open(&pc);
+
+    // 配置来源：环境变量优先，否则在标定形状上自动选择
+    prefetch_config pf = {0, 0, 1, 1};
+    const char* source = "环境变量";
+    double t0 = now_sec();
+    if (!prefetch_from_env(&pf)) {
+        pf = prefetch_autotune();
+        source = "自动选择";
+    }
+    char params[64];
+    format_config(&pf, params, sizeof(params));
+    printf("线程数: %d  预取配置 (%s, %.2f 秒): %s\n", omp_get_max_threads(), source, now_sec() - t0, params);
+
+    int ok = 0;
+    for (int i = 0; i < NUM_COUNTERS; i++) ok += pc.fd[i] >= 0;
+    if (ok < NUM_COUNTERS) printf("注意: %d 个硬件计数器不可用 (检查 perf_event_paranoid)\n", NUM_COUNTERS - ok);
+
+    if (argc == 4) {
+        ablation(atoi(argv[1]), atoi(argv[2]), atoi(argv[3]), &pf, source, &pc);
+    } else {
+        ablation(4096, 4096, 4096, &pf, source, &pc);
+        ablation(2000, 3000, 1000, &pf, source, &pc);
+    }
+    counters_close(&pc);
+    return 0;
+}
@@ -8,7 +8,8 @@
 #define L1_BLOCK_SIZE 64
 #define L2_BLOCK_SIZE 512
 #define FLOPS_PER_OP (2.0 * N * N * N)
-#define PREFETCH_DISTANCE 128
+// 预取距离 (k 步)：原来的 128 比 L1 块 (64) 还长，下面的条件永远不成立
+#define PREFETCH_DISTANCE 8
 
 void init_matrix(float* M);
 
@@ -35,7 +36,7 @@ void mat_mul_blocked(float* A, float* B, float* C) {
                                         float* b_row = &B[k * N];
                                         
                                         // 预取
-                                        if (k + PREFETCH_DISTANCE < l1_k + L1_BLOCK_SIZE) {
+                                        if (k + PREFETCH_DISTANCE < N) {
                                             _mm_prefetch((char*)&A[i * N + k + PREFETCH_DISTANCE], _MM_HINT_T0);
                                             _mm_prefetch((char*)&B[(k + PREFETCH_DISTANCE) * N + j], _MM_HINT_T0);
                                             _mm_prefetch((char*)&B[(k + PREFETCH_DISTANCE) * N + j + 16], _MM_HINT_T0);
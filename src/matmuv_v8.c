@@ -63,11 +63,11 @@ void mat_mul_blocked(float** A, float** B, float** C) {
 
                                     __m512 c_vec1 = _mm512_load_ps(&C[i][j]);
                                     __m512 c_vec2 = _mm512_load_ps(&C[i][j + 16]);
-                                                                            // 预取下一轮A和B的数据
-                                    // if (l1_k + prefetch_distance < l2_k + L2_BLOCK_SIZE) {
-                                    //     _mm_prefetch(&A[i][l1_k + prefetch_distance], _MM_HINT_T0);
-                                    //     _mm_prefetch(&B[l1_k + prefetch_distance][j], _MM_HINT_T0);
-                                    // }
+                                    // 预取下一轮A和B的数据
+                                    if (l1_k + prefetch_distance < l2_k + L2_BLOCK_SIZE) {
+                                        _mm_prefetch((const char*)&A[i][l1_k + prefetch_distance], _MM_HINT_T0);
+                                        _mm_prefetch((const char*)&B[l1_k + prefetch_distance][j], _MM_HINT_T0);
+                                    }
 
                                     // 累加
                                     for (int k = l1_k; k < l1_k + L1_BLOCK_SIZE && k < N - 1; k+=2) {